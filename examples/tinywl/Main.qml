@@ -71,6 +71,10 @@ Item {
             keyboardFocus: Helper.getFocusSurfaceFrom(renderWindow.activeFocusItem)
         }
 
+        VirtualInputManager {
+            seat: seat0.seat
+        }
+
         WaylandSocket {
             id: masterSocket
 
@@ -18,21 +18,6 @@ OutputPositioner {
         output: waylandOutput
         devicePixelRatio: parent.devicePixelRatio
         anchors.centerIn: parent
-        cursorDelegate: Item {
-            required property OutputCursor cursor
-
-            visible: cursor.visible && !cursor.isHardwareCursor
-
-            Image {
-                source: cursor.imageSource
-                x: -cursor.hotspot.x
-                y: -cursor.hotspot.y
-                cache: false
-                width: cursor.size.width
-                height: cursor.size.height
-                sourceClipRect: cursor.sourceRect
-            }
-        }
 
         RotationAnimation {
             id: rotationAnimator
@@ -236,15 +236,7 @@ Item {
             OutputLayoutItem {
                 anchors.fill: parent
                 layout: QmlHelper.layout
-
-                onEnterOutput: function(output) {
-                    if (surface.waylandSurface.surface)
-                        surface.waylandSurface.surface.enterOutput(output);
-                }
-                onLeaveOutput: function(output) {
-                    if (surface.waylandSurface.surface)
-                        surface.waylandSurface.surface.leaveOutput(output);
-                }
+                surface: waylandSurface.surface
             }
         }
     }
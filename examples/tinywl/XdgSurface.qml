@@ -13,12 +13,6 @@ XdgSurfaceItem {
     OutputLayoutItem {
         anchors.fill: parent
         layout: QmlHelper.layout
-
-        onEnterOutput: function(output) {
-            waylandSurface.surface.enterOutput(output);
-        }
-        onLeaveOutput: function(output) {
-            waylandSurface.surface.leaveOutput(output);
-        }
+        surface: waylandSurface.surface
     }
 }
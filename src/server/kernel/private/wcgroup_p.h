@@ -0,0 +1,27 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <QString>
+
+#include <sys/types.h>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// Helpers of the cgroup v2 unified hierarchy
+class WCgroup
+{
+public:
+    // The path of the cgroup relative to /sys/fs/cgroup, e.g. "/user.slice/app.scope"
+    static QString cgroupOf(pid_t pid);
+    // The cgroup of pid if no other process is in it and it's not the cgroup
+    // of compositor, otherwise empty. The apps started by a terminal or a
+    // launcher often share a scope, changing it affects all of them.
+    static QString exclusiveCgroupOf(pid_t pid);
+    static QString filePath(const QString &cgroup, const QString &fileName);
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -57,6 +57,7 @@ public:
 
     QW_NAMESPACE::QWCursor *handle;
     QW_NAMESPACE::QWXCursorManager *xcursor_manager = nullptr;
+    QByteArray xcursorName;
     QCursor cursor;
 
     WSeat *seat = nullptr;
@@ -24,6 +24,8 @@ public:
     ~WServerPrivate();
 
     void init();
+    void initEventNotifier();
+    void flushClients();
     void stop();
 
     void initSocket(WSocket *socketServer);
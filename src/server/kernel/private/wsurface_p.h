@@ -8,6 +8,13 @@
 #include <qwglobal.h>
 #include <QObject>
 #include <QPointer>
+#include <QElapsedTimer>
+
+#include <array>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
 
 struct wlr_surface;
 struct wlr_subsurface;
@@ -24,6 +31,10 @@ public:
     WSurfacePrivate(WSurface *qq, QW_NAMESPACE::QWSurface *handle);
     ~WSurfacePrivate();
 
+    static WSurfacePrivate *get(WSurface *qq) {
+        return static_cast<WSurfacePrivate*>(WObjectPrivate::get(qq));
+    }
+
     wl_client *waylandClient() const override;
     wlr_surface *nativeHandle() const;
 
@@ -34,7 +45,7 @@ public:
 
     void init();
     void connect();
-    void updateOutputs();
+    void removeOutput(WOutput *output);
     void setPrimaryOutput(WOutput *output);
     void setBuffer(QW_NAMESPACE::QWBuffer *newBuffer);
     void updateBuffer();
@@ -58,6 +69,13 @@ public:
     QVector<WOutput*> outputs;
     WOutput *primaryOutput = nullptr;
     QMetaObject::Connection frameDoneConnection;
+
+    // Started when the frame done is sent, and stopped at the next commit
+    QElapsedTimer frameDoneSent;
+    std::array<int, 16> turnarounds;
+    int turnaroundCount = 0;
+    int turnaroundIndex = 0;
+    QTimer *frameDoneTimer = nullptr;
 };
 
 WAYLIB_SERVER_END_NAMESPACE
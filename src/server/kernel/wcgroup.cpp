@@ -0,0 +1,51 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "private/wcgroup_p.h"
+
+#include <QFile>
+
+#include <unistd.h>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+QString WCgroup::cgroupOf(pid_t pid)
+{
+    QFile file(QStringLiteral("/proc/%1/cgroup").arg(pid));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    // Only the cgroup v2 unified hierarchy, the line is "0::/path"
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.startsWith("0::"))
+            return QString::fromLocal8Bit(line.mid(3));
+    }
+
+    return {};
+}
+
+QString WCgroup::exclusiveCgroupOf(pid_t pid)
+{
+    const QString cgroup = cgroupOf(pid);
+    if (cgroup.isEmpty() || cgroup == cgroupOf(getpid()))
+        return {};
+
+    QFile file(filePath(cgroup, QStringLiteral("cgroup.procs")));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    // One pid per line
+    const QByteArray procs = file.readAll().trimmed();
+    if (procs != QByteArray::number(pid))
+        return {};
+
+    return cgroup;
+}
+
+QString WCgroup::filePath(const QString &cgroup, const QString &fileName)
+{
+    return QStringLiteral("/sys/fs/cgroup%1/%2").arg(cgroup, fileName);
+}
+
+WAYLIB_SERVER_END_NAMESPACE
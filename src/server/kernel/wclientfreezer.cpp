@@ -0,0 +1,423 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wclientfreezer.h"
+#include "wtoplevelsurface.h"
+#include "wsurface.h"
+#include "private/wcgroup_p.h"
+#ifndef DISABLE_XWAYLAND
+#include "wxwaylandsurface.h"
+#endif
+
+#include <qwcompositor.h>
+#ifndef DISABLE_XWAYLAND
+#include <qwxwaylandsurface.h>
+#endif
+
+#include <QTimer>
+#include <QFile>
+#include <QLoggingCategory>
+
+extern "C" {
+#include <wayland-server-core.h>
+#define static
+#include <wlr/types/wlr_compositor.h>
+#ifndef DISABLE_XWAYLAND
+#include <wlr/xwayland.h>
+#endif
+#undef static
+}
+
+#include <signal.h>
+#include <unistd.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcFreezer, "waylib.server.freezer", QtWarningMsg)
+
+struct FreezeGroup;
+struct ToplevelState
+{
+    WToplevelSurface *toplevel;
+    FreezeGroup *group = nullptr;
+    bool hidden = false;
+    QMetaObject::Connection mappedConnection;
+};
+
+// All toplevels of a wayland client, or of a X11 client (by pid)
+struct FreezeGroup
+{
+    wl_client *client = nullptr;
+    pid_t pid = 0;
+    bool xwayland = false;
+    QList<ToplevelState*> toplevels;
+    QTimer *graceTimer = nullptr;
+    bool frozen = false;
+    bool processFrozen = false;
+    // The cgroup frozen by cgroup.freeze, or empty if the process is stopped by SIGSTOP
+    QString frozenCgroup;
+};
+
+// Exists while the client is frozen, using to check in WSurface::notifyFrameDone
+struct FrozenClientListener
+{
+    wl_listener destroy;
+    FreezeGroup *group;
+};
+
+static void handle_frozen_client_destroy(wl_listener *listener, void *)
+{
+    FrozenClientListener *self = wl_container_of(listener, self, destroy);
+    self->group->client = nullptr;
+    wl_list_remove(&self->destroy.link);
+    delete self;
+}
+
+class WClientFreezerPrivate : public WObjectPrivate
+{
+public:
+    WClientFreezerPrivate(WClientFreezer *qq)
+        : WObjectPrivate(qq)
+    {
+
+    }
+
+    FreezeGroup *ensureGroup(WToplevelSurface *toplevel);
+    void removeGroup(FreezeGroup *group);
+    void updateMappedConnection(ToplevelState *state);
+    bool isVisible(ToplevelState *state) const;
+    void evaluate(FreezeGroup *group);
+    void freeze(FreezeGroup *group);
+    void thaw(FreezeGroup *group);
+    bool setProcessFrozen(FreezeGroup *group, bool frozen);
+
+    W_DECLARE_PUBLIC(WClientFreezer)
+
+    int gracePeriod = 5000;
+    WClientFreezer::FreezeMode mode = WClientFreezer::StopFrameCallbacks;
+    QHash<WToplevelSurface*, ToplevelState*> toplevels;
+    QList<FreezeGroup*> groups;
+};
+
+FreezeGroup *WClientFreezerPrivate::ensureGroup(WToplevelSurface *toplevel)
+{
+    wl_client *client = nullptr;
+    pid_t pid = 0;
+
+#ifndef DISABLE_XWAYLAND
+    if (auto xwayland = qobject_cast<WXWaylandSurface*>(toplevel)) {
+        pid = xwayland->handle()->handle()->pid;
+    } else
+#endif
+    if (auto surface = toplevel->surface()) {
+        client = wl_resource_get_client(surface->handle()->handle()->resource);
+        wl_client_get_credentials(client, &pid, nullptr, nullptr);
+    }
+
+    if (!client && pid <= 0)
+        return nullptr;
+
+    for (auto group : std::as_const(groups)) {
+        if (client ? group->client == client : (group->xwayland && group->pid == pid))
+            return group;
+    }
+
+    auto group = new FreezeGroup;
+    group->client = client;
+    group->pid = pid;
+    group->xwayland = !client;
+    group->graceTimer = new QTimer(q_func());
+    group->graceTimer->setSingleShot(true);
+    QObject::connect(group->graceTimer, &QTimer::timeout, q_func(), [this, group] {
+        freeze(group);
+    });
+    groups.append(group);
+
+    return group;
+}
+
+void WClientFreezerPrivate::removeGroup(FreezeGroup *group)
+{
+    thaw(group);
+    groups.removeOne(group);
+    delete group->graceTimer;
+    delete group;
+}
+
+void WClientFreezerPrivate::updateMappedConnection(ToplevelState *state)
+{
+    QObject::disconnect(state->mappedConnection);
+    if (auto surface = state->toplevel->surface()) {
+        state->mappedConnection = QObject::connect(surface, &WSurface::mappedChanged, q_func(), [this, state] {
+            evaluate(state->group);
+        });
+    }
+}
+
+bool WClientFreezerPrivate::isVisible(ToplevelState *state) const
+{
+    if (state->toplevel->isActivated())
+        return true;
+
+    return !state->hidden && !state->toplevel->isMinimized();
+}
+
+void WClientFreezerPrivate::evaluate(FreezeGroup *group)
+{
+    // Only the mapped toplevels are considered, a client is not frozen
+    // before it shows any window, or it has no window (e.g. only tray icon)
+    bool hasMapped = false;
+    bool visible = false;
+    for (auto state : std::as_const(group->toplevels)) {
+        auto surface = state->toplevel->surface();
+        if (!surface || !surface->mapped())
+            continue;
+        hasMapped = true;
+        if (isVisible(state)) {
+            visible = true;
+            break;
+        }
+    }
+
+    if (hasMapped && !visible) {
+        if (!group->frozen && !group->graceTimer->isActive())
+            group->graceTimer->start(gracePeriod);
+    } else {
+        group->graceTimer->stop();
+        thaw(group);
+    }
+}
+
+void WClientFreezerPrivate::freeze(FreezeGroup *group)
+{
+    if (group->frozen)
+        return;
+
+    group->frozen = true;
+    qCDebug(qLcFreezer) << "Freeze client" << group->client << "pid" << group->pid;
+
+    if (group->client) {
+        auto listener = new FrozenClientListener;
+        listener->group = group;
+        listener->destroy.notify = handle_frozen_client_destroy;
+        wl_client_add_destroy_listener(group->client, &listener->destroy);
+    }
+
+    if (mode == WClientFreezer::FreezeProcess)
+        group->processFrozen = setProcessFrozen(group, true);
+
+    for (auto state : std::as_const(group->toplevels))
+        Q_EMIT q_func()->frozen(state->toplevel);
+}
+
+void WClientFreezerPrivate::thaw(FreezeGroup *group)
+{
+    if (!group->frozen)
+        return;
+
+    group->frozen = false;
+    qCDebug(qLcFreezer) << "Thaw client" << group->client << "pid" << group->pid;
+
+    if (group->processFrozen) {
+        setProcessFrozen(group, false);
+        group->processFrozen = false;
+    }
+
+    if (group->client) {
+        auto listener = wl_client_get_destroy_listener(group->client, handle_frozen_client_destroy);
+        if (listener) {
+            FrozenClientListener *self = wl_container_of(listener, self, destroy);
+            wl_list_remove(&self->destroy.link);
+            delete self;
+        }
+    }
+
+    for (auto state : std::as_const(group->toplevels))
+        Q_EMIT q_func()->thawed(state->toplevel);
+}
+
+bool WClientFreezerPrivate::setProcessFrozen(FreezeGroup *group, bool frozen)
+{
+    if (group->pid <= 0 || group->pid == getpid())
+        return false;
+
+    // The other connections of this process maybe are visible
+    if (frozen) {
+        for (auto other : std::as_const(groups)) {
+            if (other != group && other->pid == group->pid && !other->frozen)
+                return false;
+        }
+    }
+
+    // Don't freeze the other processes in the same cgroup, they maybe are visible.
+    // Thaw by the way of the freeze, the cgroup maybe isn't exclusive any more.
+    const QString cgroup = frozen ? WCgroup::exclusiveCgroupOf(group->pid)
+                                  : std::exchange(group->frozenCgroup, QString());
+    if (!cgroup.isEmpty()) {
+        QFile file(WCgroup::filePath(cgroup, QStringLiteral("cgroup.freeze")));
+        if (file.open(QIODevice::WriteOnly) && file.write(frozen ? "1" : "0") > 0) {
+            if (frozen)
+                group->frozenCgroup = cgroup;
+            return true;
+        }
+    }
+
+    if (kill(group->pid, frozen ? SIGSTOP : SIGCONT) == 0)
+        return true;
+
+    qCWarning(qLcFreezer) << "Can't" << (frozen ? "freeze" : "thaw") << "the process" << group->pid;
+    return false;
+}
+
+WClientFreezer::WClientFreezer(QObject *parent)
+    : QObject(parent)
+    , WObject(*new WClientFreezerPrivate(this))
+{
+
+}
+
+WClientFreezer::~WClientFreezer()
+{
+    W_D(WClientFreezer);
+
+    const auto list = d->toplevels.keys();
+    for (auto toplevel : list)
+        removeToplevel(toplevel);
+}
+
+int WClientFreezer::gracePeriod() const
+{
+    W_DC(WClientFreezer);
+    return d->gracePeriod;
+}
+
+void WClientFreezer::setGracePeriod(int newGracePeriod)
+{
+    W_D(WClientFreezer);
+    if (d->gracePeriod == newGracePeriod)
+        return;
+    d->gracePeriod = newGracePeriod;
+    Q_EMIT gracePeriodChanged();
+}
+
+WClientFreezer::FreezeMode WClientFreezer::mode() const
+{
+    W_DC(WClientFreezer);
+    return d->mode;
+}
+
+void WClientFreezer::setMode(FreezeMode newMode)
+{
+    W_D(WClientFreezer);
+    if (d->mode == newMode)
+        return;
+    d->mode = newMode;
+
+    for (auto group : std::as_const(d->groups)) {
+        if (!group->frozen)
+            continue;
+        if (newMode == FreezeProcess && !group->processFrozen) {
+            group->processFrozen = d->setProcessFrozen(group, true);
+        } else if (newMode != FreezeProcess && group->processFrozen) {
+            d->setProcessFrozen(group, false);
+            group->processFrozen = false;
+        }
+    }
+
+    Q_EMIT modeChanged();
+}
+
+void WClientFreezer::addToplevel(WToplevelSurface *toplevel)
+{
+    W_D(WClientFreezer);
+    if (!toplevel || d->toplevels.contains(toplevel))
+        return;
+
+    auto group = d->ensureGroup(toplevel);
+    if (!group) {
+        qCWarning(qLcFreezer) << "Can't get the client of" << toplevel;
+        return;
+    }
+
+    auto state = new ToplevelState;
+    state->toplevel = toplevel;
+    state->group = group;
+    group->toplevels.append(state);
+    d->toplevels.insert(toplevel, state);
+
+    auto evaluate = [d, state] {
+        d->evaluate(state->group);
+    };
+    connect(toplevel, &WToplevelSurface::minimizeChanged, this, evaluate);
+    connect(toplevel, &WToplevelSurface::activateChanged, this, evaluate);
+    connect(toplevel, &WToplevelSurface::surfaceChanged, this, [d, state] {
+        d->updateMappedConnection(state);
+        d->evaluate(state->group);
+    });
+    connect(toplevel, &QObject::destroyed, this, [this, toplevel] {
+        removeToplevel(toplevel);
+    });
+    d->updateMappedConnection(state);
+
+    // A new window of a frozen client
+    d->thaw(group);
+    d->evaluate(group);
+}
+
+void WClientFreezer::removeToplevel(WToplevelSurface *toplevel)
+{
+    W_D(WClientFreezer);
+    auto state = d->toplevels.take(toplevel);
+    if (!state)
+        return;
+
+    disconnect(toplevel, nullptr, this, nullptr);
+    QObject::disconnect(state->mappedConnection);
+
+    auto group = state->group;
+    group->toplevels.removeOne(state);
+    delete state;
+
+    if (group->toplevels.isEmpty())
+        d->removeGroup(group);
+    else
+        d->evaluate(group);
+}
+
+void WClientFreezer::setHidden(WToplevelSurface *toplevel, bool hidden)
+{
+    W_D(WClientFreezer);
+    auto state = d->toplevels.value(toplevel);
+    if (!state || state->hidden == hidden)
+        return;
+
+    state->hidden = hidden;
+    d->evaluate(state->group);
+}
+
+bool WClientFreezer::isFrozen(WToplevelSurface *toplevel) const
+{
+    W_DC(WClientFreezer);
+    auto state = d->toplevels.value(toplevel);
+    return state && state->group->frozen;
+}
+
+void WClientFreezer::thaw(WToplevelSurface *toplevel)
+{
+    W_D(WClientFreezer);
+    auto state = d->toplevels.value(toplevel);
+    if (!state)
+        return;
+
+    d->thaw(state->group);
+    state->group->graceTimer->stop();
+    d->evaluate(state->group);
+}
+
+bool WClientFreezer::isFrozenClient(wl_client *client)
+{
+    return wl_client_get_destroy_listener(client, handle_frozen_client_destroy);
+}
+
+WAYLIB_SERVER_END_NAMESPACE
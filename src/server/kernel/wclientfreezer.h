@@ -0,0 +1,66 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <QObject>
+#include <QQmlEngine>
+
+struct wl_client;
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WToplevelSurface;
+class WClientFreezerPrivate;
+// Freeze a client when all of its mapped toplevels are minimized or hidden
+// (e.g. on a hidden workspace) longer than the grace period. The frame
+// callbacks of a frozen client are not sent, and its process is optionally
+// frozen by the cgroup v2 freezer (if it has its own cgroup) or SIGSTOP.
+// The X11 clients are grouped by the pid of X client, only their processes
+// are frozen, because the wl_client is the Xwayland server.
+class WAYLIB_SERVER_EXPORT WClientFreezer : public QObject, public WObject
+{
+    Q_OBJECT
+    W_DECLARE_PRIVATE(WClientFreezer)
+    Q_PROPERTY(int gracePeriod READ gracePeriod WRITE setGracePeriod NOTIFY gracePeriodChanged FINAL)
+    Q_PROPERTY(FreezeMode mode READ mode WRITE setMode NOTIFY modeChanged FINAL)
+    QML_NAMED_ELEMENT(ClientFreezer)
+
+public:
+    enum FreezeMode {
+        StopFrameCallbacks,
+        FreezeProcess
+    };
+    Q_ENUM(FreezeMode)
+
+    explicit WClientFreezer(QObject *parent = nullptr);
+    ~WClientFreezer();
+
+    // msecs
+    int gracePeriod() const;
+    void setGracePeriod(int newGracePeriod);
+
+    FreezeMode mode() const;
+    void setMode(FreezeMode newMode);
+
+    // The toplevel is removed when it's destroyed
+    Q_INVOKABLE void addToplevel(WAYLIB_SERVER_NAMESPACE::WToplevelSurface *toplevel);
+    Q_INVOKABLE void removeToplevel(WAYLIB_SERVER_NAMESPACE::WToplevelSurface *toplevel);
+    Q_INVOKABLE void setHidden(WAYLIB_SERVER_NAMESPACE::WToplevelSurface *toplevel, bool hidden);
+    Q_INVOKABLE bool isFrozen(WAYLIB_SERVER_NAMESPACE::WToplevelSurface *toplevel) const;
+    // Thaw the client of the toplevel at once, e.g. on it got the input focus,
+    // it will be frozen again after the grace period if it's still hidden.
+    Q_INVOKABLE void thaw(WAYLIB_SERVER_NAMESPACE::WToplevelSurface *toplevel);
+
+    static bool isFrozenClient(wl_client *client);
+
+Q_SIGNALS:
+    void gracePeriodChanged();
+    void modeChanged();
+    void frozen(WAYLIB_SERVER_NAMESPACE::WToplevelSurface *toplevel);
+    void thawed(WAYLIB_SERVER_NAMESPACE::WToplevelSurface *toplevel);
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -0,0 +1,354 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wclientstats.h"
+
+#include <qwdisplay.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+
+#include <algorithm>
+
+extern "C" {
+#include <wayland-server-core.h>
+#define static
+#include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_buffer.h>
+#undef static
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+static constexpr qint64 RateWindow = 1000000000; // 1s
+
+struct ClientData
+{
+    ClientData(WClientStatsPrivate *stats, wl_client *client, qint64 now)
+        : stats(stats)
+        , client(client)
+        , windowStart(now)
+    {
+
+    }
+
+    void rollWindow(qint64 now);
+
+    wl_listener destroy;
+    WClientStatsPrivate *stats;
+    wl_client *client;
+
+    qint64 totalRequests = 0;
+    qint64 totalHandlerTime = 0;
+
+    qint64 windowStart;
+    quint32 windowRequests = 0;
+    quint32 windowCommits = 0;
+    qint64 windowHandlerTime = 0;
+
+    qreal requestsPerSecond = 0;
+    qreal commitsPerSecond = 0;
+    qreal handlerTimePerSecond = 0;
+
+    // wl_shm_pool object id -> pool size
+    QHash<uint32_t, qint64> shmPools;
+};
+
+void ClientData::rollWindow(qint64 now)
+{
+    const qint64 elapsed = now - windowStart;
+    if (elapsed < RateWindow)
+        return;
+
+    const qreal seconds = elapsed / 1e9;
+    requestsPerSecond = windowRequests / seconds;
+    commitsPerSecond = windowCommits / seconds;
+    handlerTimePerSecond = windowHandlerTime / 1e6 / seconds;
+
+    windowStart = now;
+    windowRequests = 0;
+    windowCommits = 0;
+    windowHandlerTime = 0;
+}
+
+class WClientStatsPrivate : public WObjectPrivate
+{
+public:
+    WClientStatsPrivate(WClientStats *qq)
+        : WObjectPrivate(qq)
+    {
+        clock.start();
+    }
+
+    ClientData *ensureClient(wl_client *client);
+    void removeClient(ClientData *data);
+    void onRequest(const wl_protocol_logger_message *message);
+    void finishRequest();
+    WClientStatsEntry entry(ClientData *data, qint64 now) const;
+
+    static void handle_client_destroy(wl_listener *listener, void *);
+    static void handle_protocol(void *data, wl_protocol_logger_type direction,
+                                const wl_protocol_logger_message *message);
+    static void handle_idle(void *data);
+
+    W_DECLARE_PUBLIC(WClientStats)
+
+    wl_display *display = nullptr;
+    wl_event_loop *loop = nullptr;
+    wl_event_source *idleSource = nullptr;
+    QElapsedTimer clock;
+    QList<ClientData*> clients;
+
+    // The request which is dispatching, libwayland doesn't notify when
+    // a request handler is finished, so it's finished by the next request
+    // or the idle callback after the event loop dispatched the clients.
+    ClientData *currentClient = nullptr;
+    qint64 currentStart = 0;
+};
+
+ClientData *WClientStatsPrivate::ensureClient(wl_client *client)
+{
+    if (auto listener = wl_client_get_destroy_listener(client, handle_client_destroy)) {
+        ClientData *data = wl_container_of(listener, data, destroy);
+        return data;
+    }
+
+    auto data = new ClientData(this, client, clock.nsecsElapsed());
+    data->destroy.notify = handle_client_destroy;
+    wl_client_add_destroy_listener(client, &data->destroy);
+    clients.append(data);
+
+    return data;
+}
+
+void WClientStatsPrivate::removeClient(ClientData *data)
+{
+    if (currentClient == data)
+        currentClient = nullptr;
+    clients.removeOne(data);
+    wl_list_remove(&data->destroy.link);
+    delete data;
+}
+
+void WClientStatsPrivate::onRequest(const wl_protocol_logger_message *message)
+{
+    finishRequest();
+
+    auto data = ensureClient(wl_resource_get_client(message->resource));
+    const qint64 now = clock.nsecsElapsed();
+    data->rollWindow(now);
+    ++data->windowRequests;
+    ++data->totalRequests;
+
+    const char *className = wl_resource_get_class(message->resource);
+    const char *requestName = message->message->name;
+
+    if (strcmp(className, "wl_surface") == 0) {
+        if (strcmp(requestName, "commit") == 0)
+            ++data->windowCommits;
+    } else if (strcmp(className, "wl_shm") == 0) {
+        // create_pool(new_id, fd, size)
+        if (strcmp(requestName, "create_pool") == 0)
+            data->shmPools[message->arguments[0].n] = message->arguments[2].i;
+    } else if (strcmp(className, "wl_shm_pool") == 0) {
+        const uint32_t id = wl_resource_get_id(message->resource);
+        if (strcmp(requestName, "resize") == 0)
+            data->shmPools[id] = message->arguments[0].i;
+        else if (strcmp(requestName, "destroy") == 0)
+            data->shmPools.remove(id);
+    }
+
+    currentClient = data;
+    currentStart = now;
+
+    if (!idleSource)
+        idleSource = wl_event_loop_add_idle(loop, handle_idle, this);
+}
+
+void WClientStatsPrivate::finishRequest()
+{
+    if (!currentClient)
+        return;
+
+    const qint64 time = clock.nsecsElapsed() - currentStart;
+    currentClient->windowHandlerTime += time;
+    currentClient->totalHandlerTime += time;
+    currentClient = nullptr;
+}
+
+static wl_iterator_result countResource(wl_resource *resource, void *data)
+{
+    auto entry = reinterpret_cast<WClientStatsEntry*>(data);
+    ++entry->resources;
+
+    const char *className = wl_resource_get_class(resource);
+    if (strcmp(className, "wl_buffer") == 0)
+        ++entry->buffers;
+
+    if (strcmp(className, "wl_surface") != 0)
+        return WL_ITERATOR_CONTINUE;
+
+    ++entry->surfaces;
+    auto surface = wlr_surface_from_resource(resource);
+    // The wlr_surface holds a lock of its buffer, and the locks of WSurface and
+    // the texture provider are ignored (n_ignore_locks) while the client
+    // buffer is only used by the surface, the others are kept by compositor,
+    // e.g. the frozen or cached contents.
+    if (surface && surface->buffer
+        && surface->buffer->base.n_locks - surface->buffer->n_ignore_locks > 1) {
+        ++entry->lockedBuffers;
+        // The client buffer is uploaded to a texture, count it as 32bpp
+        entry->lockedBufferBytes += qint64(surface->buffer->base.width) * surface->buffer->base.height * 4;
+    }
+
+    return WL_ITERATOR_CONTINUE;
+}
+
+WClientStatsEntry WClientStatsPrivate::entry(ClientData *data, qint64 now) const
+{
+    WClientStatsEntry entry;
+    entry.client = data->client;
+
+    pid_t pid = 0;
+    uid_t uid = 0;
+    wl_client_get_credentials(data->client, &pid, &uid, nullptr);
+    entry.pid = pid;
+    entry.uid = uid;
+
+    wl_client_for_each_resource(data->client, countResource, &entry);
+
+    for (auto size : std::as_const(data->shmPools))
+        entry.shmPoolBytes += size;
+
+    data->rollWindow(now);
+    entry.requestsPerSecond = data->requestsPerSecond;
+    entry.commitsPerSecond = data->commitsPerSecond;
+    entry.handlerTimePerSecond = data->handlerTimePerSecond;
+    entry.totalRequests = data->totalRequests;
+    entry.totalHandlerTime = data->totalHandlerTime / 1000000;
+
+    return entry;
+}
+
+void WClientStatsPrivate::handle_client_destroy(wl_listener *listener, void *)
+{
+    ClientData *data = wl_container_of(listener, data, destroy);
+    data->stats->removeClient(data);
+}
+
+void WClientStatsPrivate::handle_protocol(void *data, wl_protocol_logger_type direction,
+                                          const wl_protocol_logger_message *message)
+{
+    if (direction != WL_PROTOCOL_LOGGER_REQUEST)
+        return;
+
+    reinterpret_cast<WClientStatsPrivate*>(data)->onRequest(message);
+}
+
+void WClientStatsPrivate::handle_idle(void *data)
+{
+    auto d = reinterpret_cast<WClientStatsPrivate*>(data);
+    d->idleSource = nullptr;
+    d->finishRequest();
+}
+
+WClientStats::WClientStats()
+    : WObject(*new WClientStatsPrivate(this))
+{
+
+}
+
+WClientStatsEntry WClientStats::stats(wl_client *client) const
+{
+    W_DC(WClientStats);
+
+    if (!d->display)
+        return {};
+
+    auto listener = wl_client_get_destroy_listener(client, WClientStatsPrivate::handle_client_destroy);
+    if (listener) {
+        ClientData *data = wl_container_of(listener, data, destroy);
+        return d->entry(data, d->clock.nsecsElapsed());
+    }
+
+    // The client has not sent any request yet
+    ClientData data(const_cast<WClientStatsPrivate*>(d), client, d->clock.nsecsElapsed());
+    return d->entry(&data, data.windowStart);
+}
+
+template<typename T>
+static inline auto sortBy(T WClientStatsEntry::*member)
+{
+    return [member] (const WClientStatsEntry &e1, const WClientStatsEntry &e2) {
+        return e1.*member > e2.*member;
+    };
+}
+
+QList<WClientStatsEntry> WClientStats::stats(SortKey sortKey, int limit) const
+{
+    W_DC(WClientStats);
+
+    QList<WClientStatsEntry> list;
+    if (!d->display)
+        return list;
+
+    wl_list *clientList = wl_display_get_client_list(d->display);
+    wl_client *client = nullptr;
+    wl_client_for_each(client, clientList) {
+        list.append(stats(client));
+    }
+
+    switch (sortKey) {
+    case Pid: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::pid)); break;
+    case Resources: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::resources)); break;
+    case Surfaces: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::surfaces)); break;
+    case Buffers: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::buffers)); break;
+    case LockedBuffers: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::lockedBuffers)); break;
+    case LockedBufferBytes: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::lockedBufferBytes)); break;
+    case ShmPoolBytes: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::shmPoolBytes)); break;
+    case RequestsPerSecond: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::requestsPerSecond)); break;
+    case CommitsPerSecond: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::commitsPerSecond)); break;
+    case HandlerTimePerSecond: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::handlerTimePerSecond)); break;
+    case TotalRequests: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::totalRequests)); break;
+    case TotalHandlerTime: std::sort(list.begin(), list.end(), sortBy(&WClientStatsEntry::totalHandlerTime)); break;
+    }
+
+    if (limit >= 0 && list.size() > limit)
+        list.resize(limit);
+
+    return list;
+}
+
+void WClientStats::create(WServer *server)
+{
+    W_D(WClientStats);
+
+    d->display = server->handle()->handle();
+    d->loop = wl_display_get_event_loop(d->display);
+    m_handle = wl_display_add_protocol_logger(d->display, WClientStatsPrivate::handle_protocol, d);
+}
+
+void WClientStats::destroy(WServer *server)
+{
+    Q_UNUSED(server);
+    W_D(WClientStats);
+
+    if (m_handle) {
+        wl_protocol_logger_destroy(reinterpret_cast<wl_protocol_logger*>(m_handle));
+        m_handle = nullptr;
+    }
+
+    if (d->idleSource) {
+        wl_event_source_remove(d->idleSource);
+        d->idleSource = nullptr;
+    }
+
+    while (!d->clients.isEmpty())
+        d->removeClient(d->clients.constLast());
+
+    d->display = nullptr;
+    d->loop = nullptr;
+}
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -0,0 +1,93 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <WServer>
+
+#include <QQmlEngine>
+
+struct wl_client;
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+struct WAYLIB_SERVER_EXPORT WClientStatsEntry
+{
+    Q_GADGET
+    Q_PROPERTY(qint64 pid MEMBER pid)
+    Q_PROPERTY(qint64 uid MEMBER uid)
+    Q_PROPERTY(int resources MEMBER resources)
+    Q_PROPERTY(int surfaces MEMBER surfaces)
+    Q_PROPERTY(int buffers MEMBER buffers)
+    Q_PROPERTY(int lockedBuffers MEMBER lockedBuffers)
+    Q_PROPERTY(qint64 lockedBufferBytes MEMBER lockedBufferBytes)
+    Q_PROPERTY(qint64 shmPoolBytes MEMBER shmPoolBytes)
+    Q_PROPERTY(qreal requestsPerSecond MEMBER requestsPerSecond)
+    Q_PROPERTY(qreal commitsPerSecond MEMBER commitsPerSecond)
+    Q_PROPERTY(qreal handlerTimePerSecond MEMBER handlerTimePerSecond)
+    Q_PROPERTY(qint64 totalRequests MEMBER totalRequests)
+    Q_PROPERTY(qint64 totalHandlerTime MEMBER totalHandlerTime)
+    QML_VALUE_TYPE(clientStats)
+
+public:
+    wl_client *client = nullptr;
+    qint64 pid = 0;
+    qint64 uid = 0;
+
+    int resources = 0;
+    int surfaces = 0;
+    // The wl_buffer objects of client, how many buffers it allocated
+    int buffers = 0;
+    // The buffers of surfaces which are locked by compositor beyond the
+    // surfaces own locks, e.g. kept for the frozen or cached contents
+    int lockedBuffers = 0;
+    qint64 lockedBufferBytes = 0;
+    qint64 shmPoolBytes = 0;
+
+    // Average of the last one second (or more if the client is idle)
+    qreal requestsPerSecond = 0;
+    qreal commitsPerSecond = 0;
+    // Milliseconds spent in the request handlers of this client per second
+    qreal handlerTimePerSecond = 0;
+
+    qint64 totalRequests = 0;
+    // Milliseconds
+    qint64 totalHandlerTime = 0;
+};
+
+class WClientStatsPrivate;
+// Accounting of all clients of the display, the requests are observed by the
+// wayland protocol logger, the resources are counted when querying.
+class WAYLIB_SERVER_EXPORT WClientStats : public WServerInterface, public WObject
+{
+    Q_GADGET
+    W_DECLARE_PRIVATE(WClientStats)
+public:
+    enum SortKey {
+        Pid,
+        Resources,
+        Surfaces,
+        Buffers,
+        LockedBuffers,
+        LockedBufferBytes,
+        ShmPoolBytes,
+        RequestsPerSecond,
+        CommitsPerSecond,
+        HandlerTimePerSecond,
+        TotalRequests,
+        TotalHandlerTime
+    };
+    Q_ENUM(SortKey)
+
+    WClientStats();
+
+    WClientStatsEntry stats(wl_client *client) const;
+    // Sorted in descending order, limit < 0 is no limit
+    QList<WClientStatsEntry> stats(SortKey sortBy = HandlerTimePerSecond, int limit = -1) const;
+
+protected:
+    void create(WServer *server) override;
+    void destroy(WServer *server) override;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -85,6 +85,7 @@ void WCursorPrivate::setType(const char *name)
     if (!xcursor_manager)
         return;
     handle->setXCursor(xcursor_manager, name);
+    xcursorName = name;
 }
 
 static inline const char *qcursorToType(const QCursor &cursor) {
@@ -199,6 +200,7 @@ void WCursorPrivate::updateCursorImage()
         return; // Using the wl_client's cursor resource
 
     surfaceOfCursor.clear();
+    xcursorName.clear();
 
     if (!visible)
         return;
@@ -570,6 +572,18 @@ void WCursor::setXCursorManager(QWXCursorManager *manager)
     d->updateCursorImage();
 }
 
+QWXCursorManager *WCursor::xcursorManager() const
+{
+    W_DC(WCursor);
+    return d->xcursor_manager;
+}
+
+QByteArray WCursor::xcursorName() const
+{
+    W_DC(WCursor);
+    return d->xcursorName;
+}
+
 QCursor WCursor::cursor() const
 {
     W_DC(WCursor);
@@ -591,6 +605,7 @@ void WCursor::setSurface(QWSurface *surface, const QPoint &hotspot)
         d->surfaceOfCursor->disconnect(this);
     d->surfaceOfCursor = surface;
     d->surfaceCursorHotspot = hotspot;
+    d->xcursorName.clear();
     if (d->visible) {
         d->handle->setSurface(surface, hotspot);
         if (surface) {
@@ -693,6 +708,7 @@ void WCursor::setVisible(bool visible)
         if (d->surfaceOfCursor)
             d->surfaceOfCursor->disconnect(this);
         d->handle->unsetImage();
+        d->xcursorName.clear();
     }
 }
 
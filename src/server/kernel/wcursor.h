@@ -83,6 +83,9 @@ public:
     static Qt::CursorShape defaultCursor();
 
     void setXCursorManager(QW_NAMESPACE::QWXCursorManager *manager);
+    QW_NAMESPACE::QWXCursorManager *xcursorManager() const;
+    // The name of the xcursor in use, empty if the image is from a surface or a QCursor pixmap
+    QByteArray xcursorName() const;
     QCursor cursor() const;
     void setCursor(const QCursor &cursor);
     void setSurface(QW_NAMESPACE::QWSurface *surface, const QPoint &hotspot);
@@ -0,0 +1,427 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wforegroundbooster.h"
+#include "wseat.h"
+#include "private/wcgroup_p.h"
+
+#include <qwseat.h>
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QLoggingCategory>
+
+extern "C" {
+#include <wayland-server-core.h>
+#define static
+#include <wlr/types/wlr_seat.h>
+#undef static
+}
+
+#include <linux/capability.h>
+#include <sys/resource.h>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcBooster, "waylib.server.booster", QtWarningMsg)
+
+enum class BoostLevel {
+    Default,
+    Foreground,
+    Background
+};
+
+struct ProcessState
+{
+    pid_t pid = 0;
+    BoostLevel level = BoostLevel::Default;
+    QList<wl_client*> clients;
+    // thread id -> nice value before changed
+    QHash<pid_t, int> originalNice;
+    // Empty if the process has no own cgroup
+    QString weightFile;
+    int originalWeight = 0;
+};
+
+struct ClientListener
+{
+    wl_listener destroy;
+    WForegroundBoosterPrivate *booster;
+    wl_client *client;
+    ProcessState *process;
+};
+
+static QList<pid_t> threadsOf(pid_t pid)
+{
+    QList<pid_t> threads;
+    const auto tasks = QDir(QStringLiteral("/proc/%1/task").arg(pid)).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const auto &task : tasks) {
+        bool ok = false;
+        pid_t tid = task.toInt(&ok);
+        if (ok)
+            threads.append(tid);
+    }
+
+    return threads;
+}
+
+// The lowest nice value the compositor can set, lower the nice value
+// requires CAP_SYS_NICE or RLIMIT_NICE
+static int queryLowestNice()
+{
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly)) {
+        while (!status.atEnd()) {
+            const QByteArray line = status.readLine();
+            if (!line.startsWith("CapEff:"))
+                continue;
+            bool ok = false;
+            const qulonglong caps = line.mid(7).trimmed().toULongLong(&ok, 16);
+            if (ok && (caps & (1ull << CAP_SYS_NICE)))
+                return -20;
+            break;
+        }
+    }
+
+    rlimit limit;
+    if (getrlimit(RLIMIT_NICE, &limit) < 0)
+        return 20;
+    if (limit.rlim_cur == RLIM_INFINITY)
+        return -20;
+    return qBound<int>(-20, 20 - int(qMin<rlim_t>(limit.rlim_cur, 40)), 20);
+}
+
+class WForegroundBoosterPrivate : public WObjectPrivate
+{
+public:
+    WForegroundBoosterPrivate(WForegroundBooster *qq, WSeat *seat)
+        : WObjectPrivate(qq)
+        , seat(seat)
+        , lowestNice(queryLowestNice())
+    {
+        focusChange.notify = handle_focus_change;
+    }
+
+    ProcessState *ensureProcess(wl_client *client);
+    void removeClient(ClientListener *listener);
+    void setForegroundClient(wl_client *client);
+    void setLevel(ProcessState *process, BoostLevel level);
+    void applyLevel(ProcessState *process);
+    void applyAll();
+    void restoreAll();
+
+    static void handle_focus_change(wl_listener *listener, void *data);
+    static void handle_client_destroy(wl_listener *listener, void *);
+
+    W_DECLARE_PUBLIC(WForegroundBooster)
+
+    WSeat *seat;
+    int foregroundNice = -5;
+    int backgroundNice = 2;
+    int foregroundWeight = 200;
+    int backgroundWeight = 50;
+    const int lowestNice;
+
+    wl_listener focusChange;
+    bool focusListening = false;
+    wl_client *foregroundClient = nullptr;
+    QHash<pid_t, ProcessState*> processes;
+    QHash<wl_client*, ClientListener*> clients;
+};
+
+ProcessState *WForegroundBoosterPrivate::ensureProcess(wl_client *client)
+{
+    if (auto listener = clients.value(client))
+        return listener->process;
+
+    pid_t pid = 0;
+    wl_client_get_credentials(client, &pid, nullptr, nullptr);
+    // Don't touch the compositor self, e.g. the clients created by WSocket::createClient
+    if (pid <= 0 || pid == getpid())
+        return nullptr;
+
+    auto process = processes.value(pid);
+    if (!process) {
+        process = new ProcessState;
+        process->pid = pid;
+
+        // The cpu.weight is of the whole cgroup, only use it if no other process shares
+        // the cgroup, so the original weight is of this process only, and it's restored
+        // when the process is untracked.
+        const QString cgroup = WCgroup::exclusiveCgroupOf(pid);
+        const QString weightFile = WCgroup::filePath(cgroup, QStringLiteral("cpu.weight"));
+        if (!cgroup.isEmpty() && access(weightFile.toLocal8Bit().constData(), R_OK | W_OK) == 0) {
+            QFile file(weightFile);
+            if (file.open(QIODevice::ReadOnly)) {
+                bool ok = false;
+                process->originalWeight = file.readAll().trimmed().toInt(&ok);
+                if (ok)
+                    process->weightFile = weightFile;
+            }
+        }
+
+        if (process->weightFile.isEmpty()) {
+            const auto threads = threadsOf(pid);
+            for (auto tid : threads) {
+                errno = 0;
+                int nice = getpriority(PRIO_PROCESS, tid);
+                if (errno == 0)
+                    process->originalNice[tid] = nice;
+            }
+        }
+
+        qCDebug(qLcBooster) << "Track process" << pid << "cgroup" << cgroup
+                            << (process->weightFile.isEmpty() ? "using nice" : "using cpu.weight");
+        processes.insert(pid, process);
+    }
+
+    auto listener = new ClientListener;
+    listener->booster = this;
+    listener->client = client;
+    listener->process = process;
+    listener->destroy.notify = handle_client_destroy;
+    wl_client_add_destroy_listener(client, &listener->destroy);
+    clients.insert(client, listener);
+    process->clients.append(client);
+
+    return process;
+}
+
+void WForegroundBoosterPrivate::removeClient(ClientListener *listener)
+{
+    auto process = listener->process;
+    process->clients.removeOne(listener->client);
+    clients.remove(listener->client);
+    if (foregroundClient == listener->client)
+        foregroundClient = nullptr;
+
+    wl_list_remove(&listener->destroy.link);
+    delete listener;
+
+    if (process->clients.isEmpty()) {
+        // The process maybe is still alive, e.g. it only closed the wayland connection
+        setLevel(process, BoostLevel::Default);
+        processes.remove(process->pid);
+        delete process;
+    }
+}
+
+void WForegroundBoosterPrivate::setForegroundClient(wl_client *client)
+{
+    if (foregroundClient == client)
+        return;
+
+    auto oldProcess = foregroundClient ? ensureProcess(foregroundClient) : nullptr;
+    auto newProcess = client ? ensureProcess(client) : nullptr;
+    foregroundClient = client;
+
+    if (newProcess)
+        setLevel(newProcess, BoostLevel::Foreground);
+    if (oldProcess && oldProcess != newProcess)
+        setLevel(oldProcess, BoostLevel::Background);
+}
+
+void WForegroundBoosterPrivate::setLevel(ProcessState *process, BoostLevel level)
+{
+    if (process->level == level)
+        return;
+
+    process->level = level;
+    applyLevel(process);
+}
+
+void WForegroundBoosterPrivate::applyLevel(ProcessState *process)
+{
+    if (!process->weightFile.isEmpty()) {
+        int weight = 0;
+        if (process->level == BoostLevel::Foreground)
+            weight = foregroundWeight;
+        else if (process->level == BoostLevel::Background)
+            weight = backgroundWeight;
+        if (weight <= 0)
+            weight = process->originalWeight;
+
+        QFile file(process->weightFile);
+        if (!file.open(QIODevice::WriteOnly) || file.write(QByteArray::number(weight)) < 0)
+            qCDebug(qLcBooster) << "Can't write" << process->weightFile << file.errorString();
+
+        return;
+    }
+
+    int delta = 0;
+    if (process->level == BoostLevel::Foreground)
+        delta = foregroundNice;
+    else if (process->level == BoostLevel::Background)
+        delta = backgroundNice;
+
+    // The threads created after tracked are inherited the nice of the main thread
+    const int mainOriginal = process->originalNice.value(process->pid, 0);
+    const auto threads = threadsOf(process->pid);
+    for (auto tid : threads) {
+        const int original = process->originalNice.value(tid, mainOriginal);
+        int nice = qBound(-20, original + delta, 19);
+        if (nice < original) {
+            // Boost as far as the limit allows
+            nice = qMax(nice, qMin(original, lowestNice));
+        } else if (nice > original && original < lowestNice) {
+            // Can't restore the original nice after raised, don't penalize
+            // the background, only the cpu.weight of cgroup is used for it
+            nice = original;
+        }
+
+        if (setpriority(PRIO_PROCESS, tid, nice) < 0) {
+            if (process->level == BoostLevel::Default)
+                qCWarning(qLcBooster) << "Can't restore nice" << nice << "for thread" << tid << strerror(errno);
+            else
+                qCDebug(qLcBooster) << "Can't set nice" << nice << "for thread" << tid << strerror(errno);
+        }
+    }
+}
+
+void WForegroundBoosterPrivate::applyAll()
+{
+    for (auto process : std::as_const(processes))
+        applyLevel(process);
+}
+
+void WForegroundBoosterPrivate::restoreAll()
+{
+    const auto list = clients.values();
+    for (auto listener : list)
+        removeClient(listener);
+
+    Q_ASSERT(processes.isEmpty());
+    foregroundClient = nullptr;
+}
+
+void WForegroundBoosterPrivate::handle_focus_change(wl_listener *listener, void *data)
+{
+    WForegroundBoosterPrivate *self = wl_container_of(listener, self, focusChange);
+    auto event = reinterpret_cast<wlr_seat_keyboard_focus_change_event*>(data);
+    self->setForegroundClient(event->new_surface ? wl_resource_get_client(event->new_surface->resource) : nullptr);
+}
+
+void WForegroundBoosterPrivate::handle_client_destroy(wl_listener *listener, void *)
+{
+    ClientListener *self = wl_container_of(listener, self, destroy);
+    self->booster->removeClient(self);
+}
+
+WForegroundBooster::WForegroundBooster(WSeat *seat)
+    : WObject(*new WForegroundBoosterPrivate(this, seat))
+{
+
+}
+
+WSeat *WForegroundBooster::seat() const
+{
+    W_DC(WForegroundBooster);
+    return d->seat;
+}
+
+int WForegroundBooster::foregroundNice() const
+{
+    W_DC(WForegroundBooster);
+    return d->foregroundNice;
+}
+
+void WForegroundBooster::setForegroundNice(int nice)
+{
+    W_D(WForegroundBooster);
+    if (d->foregroundNice == nice)
+        return;
+    d->foregroundNice = nice;
+    d->applyAll();
+}
+
+int WForegroundBooster::backgroundNice() const
+{
+    W_DC(WForegroundBooster);
+    return d->backgroundNice;
+}
+
+void WForegroundBooster::setBackgroundNice(int nice)
+{
+    W_D(WForegroundBooster);
+    if (d->backgroundNice == nice)
+        return;
+    d->backgroundNice = nice;
+    d->applyAll();
+}
+
+int WForegroundBooster::foregroundWeight() const
+{
+    W_DC(WForegroundBooster);
+    return d->foregroundWeight;
+}
+
+void WForegroundBooster::setForegroundWeight(int weight)
+{
+    W_D(WForegroundBooster);
+    weight = weight > 0 ? qBound(1, weight, 10000) : 0;
+    if (d->foregroundWeight == weight)
+        return;
+    d->foregroundWeight = weight;
+    d->applyAll();
+}
+
+int WForegroundBooster::backgroundWeight() const
+{
+    W_DC(WForegroundBooster);
+    return d->backgroundWeight;
+}
+
+void WForegroundBooster::setBackgroundWeight(int weight)
+{
+    W_D(WForegroundBooster);
+    weight = weight > 0 ? qBound(1, weight, 10000) : 0;
+    if (d->backgroundWeight == weight)
+        return;
+    d->backgroundWeight = weight;
+    d->applyAll();
+}
+
+wl_client *WForegroundBooster::foregroundClient() const
+{
+    W_DC(WForegroundBooster);
+    return d->foregroundClient;
+}
+
+void WForegroundBooster::create(WServer *server)
+{
+    Q_UNUSED(server);
+    W_D(WForegroundBooster);
+
+    if (!d->seat || !d->seat->handle()) {
+        qCWarning(qLcBooster) << "The seat is not created, the booster must attach after the seat";
+        return;
+    }
+
+    wl_signal_add(&d->seat->handle()->handle()->keyboard_state.events.focus_change, &d->focusChange);
+    d->focusListening = true;
+    m_handle = d->seat->handle();
+
+    if (auto surface = d->seat->handle()->handle()->keyboard_state.focused_surface)
+        d->setForegroundClient(wl_resource_get_client(surface->resource));
+}
+
+void WForegroundBooster::destroy(WServer *server)
+{
+    Q_UNUSED(server);
+    W_D(WForegroundBooster);
+
+    if (d->focusListening) {
+        wl_list_remove(&d->focusChange.link);
+        d->focusListening = false;
+    }
+
+    d->restoreAll();
+    m_handle = nullptr;
+}
+
+WAYLIB_SERVER_END_NAMESPACE
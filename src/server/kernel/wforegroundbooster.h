@@ -0,0 +1,49 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <WServer>
+
+struct wl_client;
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WSeat;
+class WForegroundBoosterPrivate;
+// Follow the keyboard focus of the seat, boost the scheduling of the focused
+// client's process and penalize the clients which lost the focus. The cgroup v2
+// cpu.weight is used if the process has its own writable cgroup (e.g. the app
+// scope of systemd), otherwise the nice value of its threads is changed.
+// The original values are restored when the client exits or the booster is
+// destroyed, and when the penalty is 0 for the clients which lost the focus.
+class WAYLIB_SERVER_EXPORT WForegroundBooster : public WServerInterface, public WObject
+{
+    W_DECLARE_PRIVATE(WForegroundBooster)
+public:
+    WForegroundBooster(WSeat *seat);
+
+    WSeat *seat() const;
+
+    // Relative to the original nice value, e.g. -5 for boost. Lower the nice
+    // value is limited by CAP_SYS_NICE or RLIMIT_NICE, and the background
+    // nice is not applied if the original value can't be restored.
+    int foregroundNice() const;
+    void setForegroundNice(int nice);
+    int backgroundNice() const;
+    void setBackgroundNice(int nice);
+
+    // Absolute cpu.weight value (1-10000), 0 is keep the original value
+    int foregroundWeight() const;
+    void setForegroundWeight(int weight);
+    int backgroundWeight() const;
+    void setBackgroundWeight(int weight);
+
+    wl_client *foregroundClient() const;
+
+protected:
+    void create(WServer *server) override;
+    void destroy(WServer *server) override;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -7,6 +7,7 @@
 #include "woutput.h"
 #include "wsurface.h"
 #include "wxdgsurface.h"
+#include "wsocket.h"
 #include "platformplugin/qwlrootsintegration.h"
 
 #include <qwseat.h>
@@ -17,6 +18,8 @@
 #include <QQuickWindow>
 #include <QGuiApplication>
 #include <QQuickItem>
+#include <QVarLengthArray>
+#include <QHash>
 #include <QDebug>
 
 #include <qpa/qwindowsysteminterface.h>
@@ -39,6 +42,44 @@ WAYLIB_SERVER_BEGIN_NAMESPACE
 Q_LOGGING_CATEGORY(qLcWlrTouch, "waylib.server.seat", QtWarningMsg)
 Q_LOGGING_CATEGORY(qLcWlrTouchEvents, "waylib.server.seat.events", QtWarningMsg)
 
+// Compile every unique RMLVO only once, all keyboards using the same RMLVO
+// share the xkb_keymap, so whether the keymap is changed can be checked by
+// comparing the pointers.
+class KeymapCache
+{
+public:
+    ~KeymapCache() {
+        for (auto keymap : std::as_const(keymaps))
+            xkb_keymap_unref(keymap);
+        if (context)
+            xkb_context_unref(context);
+    }
+
+    static xkb_keymap *get(const xkb_rule_names &names) {
+        static KeymapCache cache;
+        return cache.keymap(names);
+    }
+
+private:
+    xkb_keymap *keymap(const xkb_rule_names &names) {
+        const QByteArray key = QByteArray(names.rules) + '\n' + names.model + '\n'
+            + names.layout + '\n' + names.variant + '\n' + names.options;
+        if (auto keymap = keymaps.value(key))
+            return keymap;
+
+        if (!context)
+            context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+        auto keymap = xkb_keymap_new_from_names(context, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        if (keymap)
+            keymaps.insert(key, keymap);
+
+        return keymap;
+    }
+
+    xkb_context *context = nullptr;
+    QHash<QByteArray, xkb_keymap*> keymaps;
+};
+
 class WSeatPrivate : public WObjectPrivate
 {
 public:
@@ -86,6 +127,12 @@ public:
             }
         }
 
+        // The motion is absolute, the client will get the latest position
+        // with the next motion after it has read its pending events
+        auto focusedClient = nativeHandle()->pointer_state.focused_client;
+        if (focusedClient && WSocket::isSlowClient(focusedClient->client))
+            return true;
+
         handle()->pointerNotifyMotion(timestamp, localPos.x(), localPos.y());
         return true;
     }
@@ -213,11 +260,26 @@ public:
     }
 
     // for keyboard event
+    inline void setKeyboard(QWKeyboard *keyboard) {
+        auto current = nativeHandle()->keyboard_state.keyboard;
+        if (current == keyboard->handle())
+            return;
+        // Change the keyboard of wlr_seat will resend the keymap to all clients,
+        // it's unnecessary if the keymap and the repeat info is not changed.
+        if (current && current->keymap == keyboard->handle()->keymap
+            && current->repeat_info.rate == keyboard->handle()->repeat_info.rate
+            && current->repeat_info.delay == keyboard->handle()->repeat_info.delay) {
+            return;
+        }
+
+        handle()->setKeyboard(keyboard);
+    }
+
     inline bool doNotifyKey(WInputDevice *device, uint32_t keycode, uint32_t state, uint32_t timestamp) {
         if (!keyboardFocusSurface())
             return false;
 
-        this->handle()->setKeyboard(qobject_cast<QWKeyboard*>(device->handle()));
+        setKeyboard(qobject_cast<QWKeyboard*>(device->handle()));
         /* Send modifiers to the client. */
         this->handle()->keyboardNotifyKey(timestamp, keycode, state);
         return true;
@@ -227,12 +289,21 @@ public:
             return false;
 
         auto keyboard = qobject_cast<QWKeyboard*>(device->handle());
-        this->handle()->setKeyboard(keyboard);
+        setKeyboard(keyboard);
         /* Send modifiers to the client. */
         this->handle()->keyboardNotifyModifiers(&keyboard->handle()->modifiers);
         return true;
     }
 
+    // for input passthrough
+    inline bool isPassthroughClient(wlr_surface *surface) const {
+        auto keyboardFocus = keyboardFocusSurface();
+        return surface && keyboardFocus
+            && wl_resource_get_client(surface->resource) == wl_resource_get_client(keyboardFocus->resource);
+    }
+    bool passthroughPointerPosition(QPointF *local) const;
+    bool matchPassthroughShortcut(QWKeyboard *keyboard, uint32_t code) const;
+
     // begin slot function
     void on_destroy();
     void on_request_set_cursor(wlr_seat_pointer_request_set_cursor_event *event);
@@ -259,6 +330,15 @@ public:
     QMetaObject::Connection onEventObjectDestroy;
     wlr_surface *oldPointerFocusSurface = nullptr;
 
+    bool inputPassthrough = false;
+    QList<WSeat::KeysymShortcut> passthroughShortcuts;
+    // the keys pressed in passthrough mode but dispatched to Qt, their
+    // release events must go to the same target
+    QVarLengthArray<uint32_t, 4> shortcutKeys;
+    // the buttons pressed in passthrough mode, keep them implicitly
+    // grabbed by the focus client even if the cursor leaves the surface
+    Qt::MouseButtons passthroughButtons;
+
     struct EventState {
         // Don't use it, its may be a invalid pointer
         void *event;
@@ -337,11 +417,83 @@ void WSeatPrivate::on_request_set_selection(wlr_seat_request_set_selection_event
     handle()->setSelection(event->source, event->serial);
 }
 
+bool WSeatPrivate::passthroughPointerPosition(QPointF *local) const
+{
+    if (!inputPassthrough || !cursor)
+        return false;
+
+    auto surface = pointerFocusSurface();
+    if (!isPassthroughClient(surface) || handle()->pointerHasGrab())
+        return false;
+
+    // Map by the event item of the surface on every event, the item maybe is
+    // moved, scaled (e.g. WSurfaceItem::surfaceSizeRatio) or transformed
+    auto item = qobject_cast<QQuickItem*>(pointerFocusEventObject.get());
+    if (!item || !item->window())
+        return false;
+
+    const QPointF pos = item->mapFromGlobal(cursor->position());
+    if (!passthroughButtons) {
+        // Let Qt handle the hover leave when the cursor leaves the surface
+        if (pos.x() < 0 || pos.y() < 0
+            || pos.x() >= surface->current.width || pos.y() >= surface->current.height)
+            return false;
+    }
+
+    *local = pos;
+    return true;
+}
+
+bool WSeatPrivate::matchPassthroughShortcut(QWKeyboard *keyboard, uint32_t code) const
+{
+    if (passthroughShortcuts.isEmpty())
+        return false;
+
+    auto state = keyboard->handle()->xkb_state;
+    const xkb_keysym_t sym = xkb_state_key_get_one_sym(state, code);
+    // Also match the unshifted keysym, e.g. "Shift+Tab" is "ISO_Left_Tab"
+    const xkb_keysym_t *baseSyms = nullptr;
+    const int baseCount = xkb_keymap_key_get_syms_by_level(xkb_state_get_keymap(state), code,
+                                                           xkb_state_key_get_layout(state, code),
+                                                           0, &baseSyms);
+    const auto modifiers = keyModifiers & (Qt::ShiftModifier | Qt::ControlModifier
+                                           | Qt::AltModifier | Qt::MetaModifier);
+
+    for (const auto &shortcut : passthroughShortcuts) {
+        if (shortcut.modifiers != modifiers)
+            continue;
+        if (shortcut.keysym == sym || (baseCount > 0 && shortcut.keysym == baseSyms[0]))
+            return true;
+    }
+
+    return false;
+}
+
 void WSeatPrivate::on_keyboard_key(wlr_keyboard_key_event *event, WInputDevice *device)
 {
     auto keyboard = qobject_cast<QWKeyboard*>(device->handle());
 
     auto code = event->keycode + 8; // map to wl_keyboard::keymap_format::keymap_format_xkb_v1
+
+    if (inputPassthrough && keyboardFocusSurface()) {
+        bool toQt = false;
+        if (event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
+            toQt = matchPassthroughShortcut(keyboard, code);
+            if (toQt)
+                shortcutKeys.append(event->keycode);
+        } else {
+            int index = shortcutKeys.indexOf(event->keycode);
+            toQt = index >= 0;
+            if (toQt)
+                shortcutKeys.remove(index);
+        }
+
+        if (!toQt) {
+            doNotifyKey(device, event->keycode, event->state, event->time_msec);
+            return;
+        }
+    }
+
     auto et = event->state == WL_KEYBOARD_KEY_STATE_PRESSED ? QEvent::KeyPress : QEvent::KeyRelease;
     xkb_keysym_t sym = xkb_state_key_get_one_sym(keyboard->handle()->xkb_state, code);
     int qtkey = QXkbCommon::keysymToQtKey(sym, keyModifiers, keyboard->handle()->xkb_state, code);
@@ -408,13 +560,11 @@ void WSeatPrivate::attachInputDevice(WInputDevice *device)
         /* We need to prepare an XKB keymap and assign it to the keyboard. This
          * assumes the defaults (e.g. layout = "us"). */
         struct xkb_rule_names rules = {};
-        struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-        struct xkb_keymap *keymap = xkb_map_new_from_names(context, &rules,
-                                                           XKB_KEYMAP_COMPILE_NO_FLAGS);
-
-        keyboard->setKeymap(keymap);
-        xkb_keymap_unref(keymap);
-        xkb_context_unref(context);
+        // Keep the keymap if it is provided by others, e.g. virtual keyboard
+        if (!keyboard->handle()->keymap) {
+            if (auto keymap = KeymapCache::get(rules))
+                keyboard->setKeymap(keymap);
+        }
         keyboard->setRepeatInfo(25, 600);
 
         QObject::connect(keyboard, &QWKeyboard::key, q_func()->server()->slotOwner(), [this, device] (wlr_keyboard_key_event *event) {
@@ -710,10 +860,45 @@ void WSeat::clearkeyboardFocusWindow()
     d->focusWindow = nullptr;
 }
 
+void WSeat::setInputPassthrough(bool on)
+{
+    W_D(WSeat);
+    if (d->inputPassthrough == on)
+        return;
+    d->inputPassthrough = on;
+    d->shortcutKeys.clear();
+    // Keep the passthroughButtons, their releases still go to the client,
+    // otherwise its implicit grab is stuck
+}
+
+bool WSeat::inputPassthrough() const
+{
+    W_DC(WSeat);
+    return d->inputPassthrough;
+}
+
+void WSeat::setPassthroughShortcuts(const QList<KeysymShortcut> &shortcuts)
+{
+    W_D(WSeat);
+    d->passthroughShortcuts = shortcuts;
+}
+
+QList<WSeat::KeysymShortcut> WSeat::passthroughShortcuts() const
+{
+    W_DC(WSeat);
+    return d->passthroughShortcuts;
+}
+
 void WSeat::notifyMotion(WCursor *cursor, WInputDevice *device, uint32_t timestamp)
 {
     W_D(WSeat);
 
+    QPointF passthroughPos;
+    if (d->passthroughPointerPosition(&passthroughPos)) {
+        d->doNotifyMotion(nullptr, nullptr, passthroughPos, timestamp);
+        return;
+    }
+
     auto qwDevice = static_cast<QPointingDevice*>(device->qtDevice());
     Q_ASSERT(qwDevice);
     QWindow *w = cursor->eventWindow();
@@ -734,6 +919,14 @@ void WSeat::notifyButton(WCursor *cursor, WInputDevice *device, Qt::MouseButton
 {
     W_D(WSeat);
 
+    QPointF passthroughPos;
+    if (state == WLR_BUTTON_RELEASED ? d->passthroughButtons.testFlag(button)
+                                     : d->passthroughPointerPosition(&passthroughPos)) {
+        d->passthroughButtons.setFlag(button, state == WLR_BUTTON_PRESSED);
+        d->doNotifyButton(WCursor::toNativeButton(button), static_cast<wlr_button_state>(state), timestamp);
+        return;
+    }
+
     auto qwDevice = static_cast<QPointingDevice*>(device->qtDevice());
     Q_ASSERT(qwDevice);
 
@@ -760,6 +953,12 @@ void WSeat::notifyAxis(WCursor *cursor, WInputDevice *device, wlr_axis_source_t
 {
     W_D(WSeat);
 
+    QPointF passthroughPos;
+    if (d->passthroughPointerPosition(&passthroughPos)) {
+        d->doNotifyAxis(static_cast<wlr_axis_source>(source), orientation, delta, delta_discrete, timestamp);
+        return;
+    }
+
     auto qwDevice = static_cast<QPointingDevice*>(device->qtDevice());
     Q_ASSERT(qwDevice);
 
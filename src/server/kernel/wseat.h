@@ -50,6 +50,11 @@ class WSeat : public WServerInterface, public WObject
 {
     W_DECLARE_PRIVATE(WSeat)
 public:
+    struct KeysymShortcut {
+        uint32_t keysym; // xkb_keysym_t
+        Qt::KeyboardModifiers modifiers;
+    };
+
     WSeat(const QString &name = QStringLiteral("seat0"));
 
     static WSeat *fromHandle(const QW_NAMESPACE::QWSeat *handle);
@@ -81,6 +86,14 @@ public:
     QWindow *focusWindow() const;
     void clearkeyboardFocusWindow();
 
+    // When enabled, the input events of the focused client are sent to
+    // wlr_seat directly, the QInputEvent and the WSeatEventFilter are skipped.
+    // Only the keys in the shortcut table are still dispatched to Qt.
+    void setInputPassthrough(bool on);
+    bool inputPassthrough() const;
+    void setPassthroughShortcuts(const QList<KeysymShortcut> &shortcuts);
+    QList<KeysymShortcut> passthroughShortcuts() const;
+
 protected:
     friend class WOutputPrivate;
     friend class WCursor;
@@ -12,6 +12,7 @@
 #include "wsurface.h"
 #include "wsocket.h"
 #include "platformplugin/qwlrootsintegration.h"
+#include "platformplugin/qwlrootseventdispatcher.h"
 
 #include <qwdisplay.h>
 #include <qwdatadevice.h>
@@ -100,13 +101,34 @@ void WServerPrivate::init()
     }
 
     loop = wl_display_get_event_loop(display->handle());
+
+    QAbstractEventDispatcher *dispatcher = QThread::currentThread()->eventDispatcher();
+    if (auto epollDispatcher = qobject_cast<QWlrootsEventDispatcher*>(dispatcher)) {
+        // The wayland event loop is a native source of this dispatcher
+        epollDispatcher->setWaylandDisplay(display->handle());
+        epollDispatcher->setFlushClientsHandler([this] {
+            flushClients();
+        });
+    } else {
+        initEventNotifier();
+    }
+
+    for (auto socket : sockets)
+        initSocket(socket);
+
+    Q_EMIT q->started();
+}
+
+void WServerPrivate::initEventNotifier()
+{
+    W_Q(WServer);
     int fd = wl_event_loop_get_fd(loop);
 
     auto processWaylandEvents = [this] {
         int ret = wl_event_loop_dispatch(loop, 0);
         if (ret)
             fprintf(stderr, "wl_event_loop_dispatch error: %d\n", ret);
-        wl_display_flush_clients(display->handle());
+        flushClients();
     };
 
     sockNot.reset(new QSocketNotifier(fd, QSocketNotifier::Read));
@@ -114,11 +136,14 @@ void WServerPrivate::init()
 
     QAbstractEventDispatcher *dispatcher = QThread::currentThread()->eventDispatcher();
     QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, q, processWaylandEvents);
+}
 
-    for (auto socket : sockets)
-        initSocket(socket);
+void WServerPrivate::flushClients()
+{
+    wl_display_flush_clients(display->handle());
 
-    Q_EMIT q->started();
+    for (auto socket : std::as_const(sockets))
+        socket->updateClientFlushStates();
 }
 
 void WServerPrivate::stop()
@@ -135,7 +160,12 @@ void WServerPrivate::stop()
 
     interfaceList.clear();
     sockNot.reset();
-    QThread::currentThread()->eventDispatcher()->disconnect(q);
+    QAbstractEventDispatcher *dispatcher = QThread::currentThread()->eventDispatcher();
+    if (auto epollDispatcher = qobject_cast<QWlrootsEventDispatcher*>(dispatcher)) {
+        epollDispatcher->setFlushClientsHandler(nullptr);
+        epollDispatcher->setWaylandDisplay(nullptr);
+    }
+    dispatcher->disconnect(q);
 
     if (display) {
         display->deleteLater();
@@ -2,20 +2,32 @@
 // SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "wsocket.h"
+#include "wsurface.h"
 
 #include <QDir>
 #include <QStandardPaths>
 #include <QStringDecoder>
 #include <QPointer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTimer>
 
 #include <wayland-server-core.h>
 
+extern "C" {
+#define static
+#include <wlr/types/wlr_compositor.h>
+#undef static
+}
+
 #include <sys/fcntl.h>
 #include <sys/stat.h>
 #include <sys/file.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
 #include <signal.h>
 
 struct wl_event_source;
@@ -131,6 +143,9 @@ public:
     void removeClient(wl_client *client);
     void destroyClient(wl_client *client);
 
+    void sampleClientFlushStates();
+    void recoverClient(wl_client *client);
+
     W_DECLARE_PUBLIC(WSocket)
 
     bool enabled = true;
@@ -143,6 +158,12 @@ public:
     wl_display *display = nullptr;
     wl_event_source *eventSource = nullptr;
     QList<wl_client*> clients;
+
+    quint32 slowClientThreshold = 64 * 1024;
+    QElapsedTimer lastFlushStateUpdate;
+    // Samples again while any client is slow, the frame callbacks of a slow
+    // client are held back, the compositor maybe is idle and never flushes.
+    QTimer *slowClientTimer = nullptr;
 };
 
 
@@ -160,6 +181,7 @@ struct WlClientDestroyListener {
 
     wl_listener destroy;
     QPointer<WSocket> socket;
+    WClientFlushState flushState;
 };
 
 WlClientDestroyListener::~WlClientDestroyListener()
@@ -186,6 +208,93 @@ void WlClientDestroyListener::handle_destroy(wl_listener *listener, void *data)
     delete self;
 }
 
+void WSocketPrivate::sampleClientFlushStates()
+{
+    W_Q(WSocket);
+    lastFlushStateUpdate.start();
+
+    bool hasSlowClient = false;
+    // Copy, the client maybe removed in the signal handlers
+    const auto clients = this->clients;
+    for (auto client : clients) {
+        auto listener = WlClientDestroyListener::get(client);
+        if (!listener)
+            continue;
+
+        auto &state = listener->flushState;
+        const int fd = wl_client_get_fd(client);
+
+        if (state.sendBufferSize == 0) {
+            int size = 0;
+            socklen_t length = sizeof(size);
+            if (getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, &length) == 0)
+                state.sendBufferSize = size;
+        }
+
+        int pending = 0;
+        if (ioctl(fd, SIOCOUTQ, &pending) < 0) {
+            hasSlowClient |= state.isSlow();
+            continue;
+        }
+        state.pendingBytes = pending;
+
+        // libwayland doesn't report the EAGAIN of the flush, but it happens
+        // when the socket buffer can't take another full wayland buffer
+        if (state.sendBufferSize > 0 && state.pendingBytes + 4096 >= state.sendBufferSize)
+            ++state.fullCount;
+
+        if (!state.isSlow() && state.pendingBytes >= slowClientThreshold) {
+            state.slowSince = QDateTime::currentMSecsSinceEpoch();
+            Q_EMIT q->slowClientDetected(client, state);
+        } else if (state.isSlow() && state.pendingBytes < slowClientThreshold / 2) {
+            recoverClient(client);
+        }
+
+        hasSlowClient |= WSocket::isSlowClient(client);
+    }
+
+    if (!hasSlowClient) {
+        if (slowClientTimer)
+            slowClientTimer->stop();
+        return;
+    }
+
+    if (!slowClientTimer) {
+        slowClientTimer = new QTimer(q);
+        slowClientTimer->setInterval(50);
+        QObject::connect(slowClientTimer, &QTimer::timeout, q, [this] {
+            sampleClientFlushStates();
+        });
+    }
+
+    if (!slowClientTimer->isActive())
+        slowClientTimer->start();
+}
+
+static wl_iterator_result notifySurfaceFrameDone(wl_resource *resource, void *)
+{
+    if (strcmp(wl_resource_get_class(resource), "wl_surface") != 0)
+        return WL_ITERATOR_CONTINUE;
+
+    if (auto surface = WSurface::fromHandle(wlr_surface_from_resource(resource)))
+        surface->notifyFrameDone();
+
+    return WL_ITERATOR_CONTINUE;
+}
+
+void WSocketPrivate::recoverClient(wl_client *client)
+{
+    auto listener = WlClientDestroyListener::get(client);
+    Q_ASSERT(listener);
+    listener->flushState.slowSince = 0;
+
+    // The frame callbacks were held back, don't wait a render which maybe
+    // never comes, the client stops drawing until it gets them.
+    wl_client_for_each_resource(client, notifySurfaceFrameDone, nullptr);
+
+    Q_EMIT q_func()->slowClientRecovered(client);
+}
+
 static bool pauseClient(wl_client *client, bool pause)
 {
     pid_t pid = 0;
@@ -551,6 +660,64 @@ QList<wl_client*> WSocket::clients() const
     return d->clients;
 }
 
+quint32 WSocket::slowClientThreshold() const
+{
+    W_DC(WSocket);
+    return d->slowClientThreshold;
+}
+
+void WSocket::setSlowClientThreshold(quint32 newThreshold)
+{
+    W_D(WSocket);
+    if (d->slowClientThreshold == newThreshold)
+        return;
+    d->slowClientThreshold = newThreshold;
+
+    if (newThreshold == 0) {
+        if (d->slowClientTimer)
+            d->slowClientTimer->stop();
+
+        // Copy, the client maybe removed in the signal handlers
+        const auto clients = d->clients;
+        for (auto client : clients) {
+            if (isSlowClient(client))
+                d->recoverClient(client);
+        }
+    }
+
+    Q_EMIT slowClientThresholdChanged();
+}
+
+WClientFlushState WSocket::clientFlushState(wl_client *client) const
+{
+    if (auto listener = WlClientDestroyListener::get(client)) {
+        if (listener->socket == this)
+            return listener->flushState;
+    }
+
+    return {};
+}
+
+bool WSocket::isSlowClient(wl_client *client)
+{
+    auto listener = WlClientDestroyListener::get(client);
+    return listener && listener->flushState.isSlow();
+}
+
+void WSocket::updateClientFlushStates()
+{
+    W_D(WSocket);
+
+    if (d->slowClientThreshold == 0 || d->clients.isEmpty())
+        return;
+
+    // It's called after every flush, don't do the syscalls too often
+    if (d->lastFlushStateUpdate.isValid() && d->lastFlushStateUpdate.elapsed() < 50)
+        return;
+
+    d->sampleClientFlushStates();
+}
+
 bool WSocket::isEnabled() const
 {
     W_DC(WSocket);
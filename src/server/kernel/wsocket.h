@@ -13,6 +13,32 @@ struct wl_client;
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
 typedef int SOCKET;
+
+// The outbound state of a client connection, sampled after the clients are flushed
+struct WAYLIB_SERVER_EXPORT WClientFlushState
+{
+    Q_GADGET
+    Q_PROPERTY(quint32 pendingBytes MEMBER pendingBytes)
+    Q_PROPERTY(quint32 sendBufferSize MEMBER sendBufferSize)
+    Q_PROPERTY(quint32 fullCount MEMBER fullCount)
+    Q_PROPERTY(qint64 slowSince MEMBER slowSince)
+    Q_PROPERTY(bool slow READ isSlow)
+
+public:
+    inline bool isSlow() const {
+        return slowSince > 0;
+    }
+
+    // The bytes in the socket which are not read by client
+    quint32 pendingBytes = 0;
+    quint32 sendBufferSize = 0;
+    // How many times the socket buffer is found full, the flush
+    // will get EAGAIN in this case
+    quint32 fullCount = 0;
+    // The msecs since epoch when the client became slow, 0 if it's not slow
+    qint64 slowSince = 0;
+};
+
 class WSocketPrivate;
 class WAYLIB_SERVER_EXPORT WSocket : public QObject, public WObject
 {
@@ -23,6 +49,7 @@ class WAYLIB_SERVER_EXPORT WSocket : public QObject, public WObject
     Q_PROPERTY(bool listening READ isListening NOTIFY listeningChanged FINAL)
     Q_PROPERTY(QString fullServerName READ fullServerName NOTIFY fullServerNameChanged FINAL)
     Q_PROPERTY(WSocket* parentSocket READ parentSocket CONSTANT)
+    Q_PROPERTY(quint32 slowClientThreshold READ slowClientThreshold WRITE setSlowClientThreshold NOTIFY slowClientThresholdChanged FINAL)
 
 public:
     explicit WSocket(bool freezeClientWhenDisable, WSocket *parentSocket = nullptr, QObject *parent = nullptr);
@@ -48,6 +75,15 @@ public:
     void removeClient(wl_client *client);
     QList<wl_client*> clients() const;
 
+    // A client is slow if its pending bytes is over the threshold, the optional
+    // events (e.g. frame done, pointer motion) will not send to it until the
+    // pending bytes is less than half of the threshold. 0 is disable.
+    quint32 slowClientThreshold() const;
+    void setSlowClientThreshold(quint32 newThreshold);
+    WClientFlushState clientFlushState(wl_client *client) const;
+    static bool isSlowClient(wl_client *client);
+    void updateClientFlushStates();
+
     bool isEnabled() const;
     void setEnabled(bool on);
 
@@ -57,6 +93,9 @@ Q_SIGNALS:
     void listeningChanged();
     void fullServerNameChanged();
     void clientsChanged();
+    void slowClientThresholdChanged();
+    void slowClientDetected(wl_client *client, const WClientFlushState &state);
+    void slowClientRecovered(wl_client *client);
 };
 
 WAYLIB_SERVER_END_NAMESPACE
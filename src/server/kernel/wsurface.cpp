@@ -7,6 +7,8 @@
 #include "wseat.h"
 #include "private/wsurface_p.h"
 #include "woutput.h"
+#include "wsocket.h"
+#include "wclientfreezer.h"
 
 #include <qwoutput.h>
 #include <qwcompositor.h>
@@ -14,6 +16,10 @@
 #include <qwtexture.h>
 #include <qwbuffer.h>
 #include <QDebug>
+#include <QTimer>
+#include <QHash>
+
+#include <algorithm>
 
 extern "C" {
 #define static
@@ -26,6 +32,55 @@ extern "C" {
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+// The surfaces on each output, an output is connected once for all of its
+// surfaces instead of once for every surface entered it
+class OutputSurfaces : public QObject
+{
+public:
+    static OutputSurfaces *instance() {
+        static OutputSurfaces *surfaces = new OutputSurfaces();
+        return surfaces;
+    }
+
+    void add(WOutput *output, WSurface *surface);
+    void remove(WOutput *output, WSurface *surface);
+
+private:
+    QHash<WOutput*, QList<WSurface*>> surfaces;
+};
+
+void OutputSurfaces::add(WOutput *output, WSurface *surface)
+{
+    auto &list = surfaces[output];
+    if (list.isEmpty()) {
+        connect(output, &WOutput::destroyed, this, [this, output] {
+            const auto list = surfaces.take(output);
+            for (auto surface : list)
+                WSurfacePrivate::get(surface)->removeOutput(output);
+        });
+        connect(output, &WOutput::scaleChanged, this, [this, output] {
+            const auto list = surfaces.value(output);
+            for (auto surface : list)
+                WSurfacePrivate::get(surface)->updatePreferredBufferScale();
+        });
+    }
+
+    list.append(surface);
+}
+
+void OutputSurfaces::remove(WOutput *output, WSurface *surface)
+{
+    auto it = surfaces.find(output);
+    if (it == surfaces.end())
+        return;
+
+    it->removeOne(surface);
+    if (it->isEmpty()) {
+        output->disconnect(this);
+        surfaces.erase(it);
+    }
+}
+
 WSurfacePrivate::WSurfacePrivate(WSurface *qq, QWSurface *handle)
     : WObjectPrivate(qq)
     , handle(handle)
@@ -38,6 +93,9 @@ WSurfacePrivate::~WSurfacePrivate()
     if (handle)
         handle->setData(this, nullptr);
 
+    for (auto output : std::as_const(outputs))
+        OutputSurfaces::instance()->remove(output, q_func());
+
     if (buffer)
         buffer->unlock();
 }
@@ -58,6 +116,18 @@ void WSurfacePrivate::on_commit()
 {
     W_Q(WSurface);
 
+    if (frameDoneSent.isValid()) {
+        const qint64 turnaround = frameDoneSent.nsecsElapsed() / 1000;
+        frameDoneSent.invalidate();
+
+        // Longer than 50ms means the client is not drawing continuously
+        if (turnaround < 50000) {
+            turnarounds[turnaroundIndex] = turnaround;
+            turnaroundIndex = (turnaroundIndex + 1) % turnarounds.size();
+            turnaroundCount = qMin<int>(turnaroundCount + 1, turnarounds.size());
+        }
+    }
+
     if (nativeHandle()->current.committed & WLR_SURFACE_STATE_BUFFER)
         updateBuffer();
 
@@ -103,25 +173,23 @@ void WSurfacePrivate::connect()
         auto surface = ensureSubsurface(sub->handle());
         Q_EMIT q->newSubsurface(surface);
 
-        for (auto output : outputs)
-            surface->enterOutput(output);
+        surface->setOutputs(outputs);
+    });
+    // The WSurface is deleted later, don't send the frame done after that
+    QObject::connect(handle.get(), &QWSurface::beforeDestroy, q, [this] {
+        if (frameDoneTimer)
+            frameDoneTimer->stop();
     });
 }
 
-void WSurfacePrivate::updateOutputs()
+void WSurfacePrivate::removeOutput(WOutput *output)
 {
-    outputs.clear();
-    wlr_surface_output *output;
-    wl_list_for_each(output, &nativeHandle()->current_outputs, link) {
-        auto qo = QWOutput::from(output->output);
-        if (!qo)
-            continue;
-        auto o = WOutput::fromHandle(qo);
-        if (!o)
-            continue;
-        outputs << o;
-    }
+    // The wlr_surface leaves the destroyed output by itself
+    if (!outputs.removeOne(output))
+        return;
 
+    if (primaryOutput == output)
+        setPrimaryOutput(outputs.isEmpty() ? nullptr : outputs.last());
     updatePreferredBufferScale();
 }
 
@@ -129,6 +197,8 @@ void WSurfacePrivate::setPrimaryOutput(WOutput *output)
 {
     W_Q(WSurface);
 
+    if (primaryOutput == output)
+        return;
     primaryOutput = output;
     Q_EMIT q->primaryOutputChanged();
 }
@@ -174,7 +244,10 @@ void WSurfacePrivate::updatePreferredBufferScale()
     float maxScale = 1.0;
     for (auto o : outputs)
         maxScale = std::max(o->scale(), maxScale);
-    preferredBufferScale = qCeil(maxScale);
+    const uint32_t newScale = qCeil(maxScale);
+    if (preferredBufferScale == newScale)
+        return;
+    preferredBufferScale = newScale;
     preferredBufferScaleChange();
 }
 
@@ -307,44 +380,79 @@ QWBuffer *WSurface::buffer() const
 void WSurface::notifyFrameDone()
 {
     W_D(WSurface);
+    if (!d->handle)
+        return;
+
+    // Don't let a client which can't keep up with its events or
+    // which is frozen draw more frames
+    auto client = wl_resource_get_client(d->nativeHandle()->resource);
+    if (WSocket::isSlowClient(client) || WClientFreezer::isFrozenClient(client))
+        return;
+
     /* This lets the client know that we've displayed that frame and it can
     * prepare another one now if it likes. */
+    if (d->frameDoneTimer)
+        d->frameDoneTimer->stop();
+
+    if (!wl_list_empty(&d->nativeHandle()->current.frame_callback_list))
+        d->frameDoneSent.start();
+
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
     wlr_surface_send_frame_done(d->nativeHandle(), &now);
 }
 
-void WSurface::enterOutput(WOutput *output)
+void WSurface::scheduleFrameDone(qint64 renderTime)
 {
     W_D(WSurface);
-    if (d->outputs.contains(output))
-        return;
-    wlr_surface_send_enter(d->nativeHandle(), output->handle()->handle());
 
-    connect(output, &WOutput::destroyed, this, [d] {
-        d->updateOutputs();
-    });
-    connect(output, &WOutput::scaleChanged, this, [d] {
-        d->updatePreferredBufferScale();
-    });
-
-    d->updateOutputs();
-
-    if (!d->primaryOutput) {
-        d->primaryOutput = output;
-        Q_EMIT primaryOutputChanged();
+    const int turnaround = commitTurnaround();
+    // Wait the samples of a few frames before delaying
+    if (renderTime <= 0 || turnaround < 0 || d->turnaroundCount < 4) {
+        notifyFrameDone();
+        return;
     }
 
-    // for subsurface
-    auto surface = d->nativeHandle();
-    wlr_subsurface *subsurface;
-    wl_list_for_each(subsurface, &surface->current.subsurfaces_below, current.link) {
-        d->ensureSubsurface(subsurface)->enterOutput(output);
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const qint64 remaining = (renderTime - (now.tv_sec * 1000000000ll + now.tv_nsec)) / 1000;
+    // Leave 2ms for the jitter of client and the latency of commit handling,
+    // QTimer is msecs precision, round down to not miss the deadline
+    const int delay = (remaining - turnaround - 2000) / 1000;
+    if (delay <= 0) {
+        notifyFrameDone();
+        return;
     }
 
-    wl_list_for_each(subsurface, &surface->current.subsurfaces_above, current.link) {
-        d->ensureSubsurface(subsurface)->enterOutput(output);
+    if (!d->frameDoneTimer) {
+        d->frameDoneTimer = new QTimer(this);
+        d->frameDoneTimer->setSingleShot(true);
+        d->frameDoneTimer->setTimerType(Qt::PreciseTimer);
+        connect(d->frameDoneTimer, &QTimer::timeout, this, &WSurface::notifyFrameDone);
     }
+
+    if (!d->frameDoneTimer->isActive())
+        d->frameDoneTimer->start(delay);
+}
+
+int WSurface::commitTurnaround() const
+{
+    W_DC(WSurface);
+    if (d->turnaroundCount == 0)
+        return -1;
+
+    return *std::max_element(d->turnarounds.cbegin(), d->turnarounds.cbegin() + d->turnaroundCount);
+}
+
+void WSurface::enterOutput(WOutput *output)
+{
+    W_D(WSurface);
+    if (d->outputs.contains(output))
+        return;
+
+    auto outputs = d->outputs;
+    outputs.append(output);
+    setOutputs(outputs);
 }
 
 void WSurface::leaveOutput(WOutput *output)
@@ -352,25 +460,50 @@ void WSurface::leaveOutput(WOutput *output)
     W_D(WSurface);
     if (!d->outputs.contains(output))
         return;
-    wlr_surface_send_leave(d->nativeHandle(), output->handle()->handle());
 
-    output->disconnect(this);
-    d->updateOutputs();
+    auto outputs = d->outputs;
+    outputs.removeOne(output);
+    setOutputs(outputs);
+}
+
+void WSurface::setOutputs(const QVector<WOutput*> &outputs)
+{
+    W_D(WSurface);
 
-    if (d->primaryOutput == output) {
-        d->primaryOutput = d->outputs.isEmpty() ? nullptr : d->outputs.last();
-        Q_EMIT primaryOutputChanged();
+    bool changed = false;
+    for (auto output : std::as_const(d->outputs)) {
+        if (outputs.contains(output))
+            continue;
+        wlr_surface_send_leave(d->nativeHandle(), output->handle()->handle());
+        OutputSurfaces::instance()->remove(output, this);
+        changed = true;
     }
 
+    for (auto output : outputs) {
+        if (d->outputs.contains(output))
+            continue;
+        wlr_surface_send_enter(d->nativeHandle(), output->handle()->handle());
+        OutputSurfaces::instance()->add(output, this);
+        changed = true;
+    }
+
+    if (!changed)
+        return;
+
+    d->outputs = outputs;
+    if (!d->primaryOutput || !outputs.contains(d->primaryOutput))
+        d->setPrimaryOutput(outputs.isEmpty() ? nullptr : outputs.last());
+    d->updatePreferredBufferScale();
+
     // for subsurface
     auto surface = d->nativeHandle();
     wlr_subsurface *subsurface;
     wl_list_for_each(subsurface, &surface->current.subsurfaces_below, current.link) {
-        d->ensureSubsurface(subsurface)->leaveOutput(output);
+        d->ensureSubsurface(subsurface)->setOutputs(outputs);
     }
 
     wl_list_for_each(subsurface, &surface->current.subsurfaces_above, current.link) {
-        d->ensureSubsurface(subsurface)->leaveOutput(output);
+        d->ensureSubsurface(subsurface)->setOutputs(outputs);
     }
 }
 
@@ -56,6 +56,14 @@ public:
     QW_NAMESPACE::QWBuffer *buffer() const;
 
     void notifyFrameDone();
+    // Send the frame done before the render of next frame starts (renderTime is
+    // CLOCK_MONOTONIC nsecs) by the measured commit turnaround, the client's buffer
+    // is committed just in time for the next frame. Send at once if renderTime is
+    // 0 or not enough samples.
+    void scheduleFrameDone(qint64 renderTime);
+    // usecs from the frame done sent to the next commit, the max of the
+    // recent frames, -1 if unknown
+    int commitTurnaround() const;
     WOutput *primaryOutput() const;
 
     bool isSubsurface() const;
@@ -69,6 +77,9 @@ public:
 public Q_SLOTS:
     void enterOutput(WOutput *output);
     void leaveOutput(WOutput *output);
+    // Enter and leave the outputs by the differences in one batch, and
+    // the subsurfaces follow the outputs of their parent
+    void setOutputs(const QVector<WOutput*> &outputs);
     QVector<WOutput*> outputs() const;
     bool inputRegionContains(const QPointF &localPos) const;
 
@@ -65,6 +65,8 @@ public Q_SLOTS:
     }
 
     virtual bool checkNewSize(const QSize &size) = 0;
+    // The size maybe is sent after the client acked the previous one,
+    // and only the last size is sent.
     virtual void resize(const QSize &size) {
         Q_UNUSED(size)
     }
@@ -0,0 +1,246 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wvirtualinput.h"
+#include "wseat.h"
+#include "winputdevice.h"
+
+#include <qwseat.h>
+#include <qwkeyboard.h>
+#include <qwpointer.h>
+#include <qwvirtualpointerv1.h>
+#include <qwvirtualkeyboardv1.h>
+
+extern "C" {
+#include <wlr/types/wlr_virtual_pointer_v1.h>
+#include <wlr/types/wlr_virtual_keyboard_v1.h>
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WVirtualPointerManagerPrivate : public WObjectPrivate
+{
+public:
+    WVirtualPointerManagerPrivate(WVirtualPointerManager *qq, WSeat *seat)
+        : WObjectPrivate(qq)
+        , seat(seat)
+    {
+
+    }
+
+    void addDevice(QWInputDevice *handle, WSeat *seat);
+    void removeDevice(WInputDevice *device);
+
+    // begin slot function
+    void on_new_pointer(wlr_virtual_pointer_v1_new_pointer_event *event);
+    // end slot function
+
+    W_DECLARE_PUBLIC(WVirtualPointerManager)
+
+    WSeat *seat;
+    QVector<WInputDevice*> deviceList;
+};
+
+void WVirtualPointerManagerPrivate::addDevice(QWInputDevice *handle, WSeat *seat)
+{
+    W_Q(WVirtualPointerManager);
+    auto device = new WInputDevice(handle);
+    deviceList << device;
+
+    QObject::connect(handle, &QWInputDevice::beforeDestroy, q->server()->slotOwner(), [this, device] {
+        // Maybe is removed in WVirtualPointerManager::destroy
+        if (deviceList.removeOne(device))
+            removeDevice(device);
+    });
+
+    if (seat)
+        seat->attachInputDevice(device);
+    q->deviceAdded(device);
+}
+
+void WVirtualPointerManagerPrivate::removeDevice(WInputDevice *device)
+{
+    if (device->seat())
+        device->seat()->detachInputDevice(device);
+    q_func()->deviceRemoved(device);
+    delete device;
+}
+
+void WVirtualPointerManagerPrivate::on_new_pointer(wlr_virtual_pointer_v1_new_pointer_event *event)
+{
+    auto targetSeat = seat;
+    if (event->suggested_seat) {
+        if (auto s = WSeat::fromHandle(QWSeat::from(event->suggested_seat)))
+            targetSeat = s;
+    }
+
+    addDevice(QWPointer::from(&event->new_pointer->pointer), targetSeat);
+}
+
+WVirtualPointerManager::WVirtualPointerManager(WSeat *seat)
+    : WObject(*new WVirtualPointerManagerPrivate(this, seat))
+{
+
+}
+
+WSeat *WVirtualPointerManager::seat() const
+{
+    W_DC(WVirtualPointerManager);
+    return d->seat;
+}
+
+QVector<WInputDevice*> WVirtualPointerManager::deviceList() const
+{
+    W_DC(WVirtualPointerManager);
+    return d->deviceList;
+}
+
+void WVirtualPointerManager::deviceAdded(WInputDevice *)
+{
+
+}
+
+void WVirtualPointerManager::deviceRemoved(WInputDevice *)
+{
+
+}
+
+void WVirtualPointerManager::create(WServer *server)
+{
+    // free follow display
+    auto manager = QWVirtualPointerManagerV1::create(server->handle());
+    Q_ASSERT(manager);
+    m_handle = manager;
+
+    QObject::connect(manager, &QWVirtualPointerManagerV1::newVirtualPointer, server->slotOwner(),
+                     [this] (wlr_virtual_pointer_v1_new_pointer_event *event) {
+        d_func()->on_new_pointer(event);
+    });
+}
+
+void WVirtualPointerManager::destroy(WServer *server)
+{
+    Q_UNUSED(server);
+    W_D(WVirtualPointerManager);
+
+    auto list = d->deviceList;
+    d->deviceList.clear();
+
+    for (auto device : list)
+        d->removeDevice(device);
+
+    m_handle = nullptr;
+}
+
+class WVirtualKeyboardManagerPrivate : public WObjectPrivate
+{
+public:
+    WVirtualKeyboardManagerPrivate(WVirtualKeyboardManager *qq, WSeat *seat)
+        : WObjectPrivate(qq)
+        , seat(seat)
+    {
+
+    }
+
+    void addDevice(QWInputDevice *handle, WSeat *seat);
+    void removeDevice(WInputDevice *device);
+
+    // begin slot function
+    void on_new_keyboard(QWVirtualKeyboardV1 *keyboard);
+    // end slot function
+
+    W_DECLARE_PUBLIC(WVirtualKeyboardManager)
+
+    WSeat *seat;
+    QVector<WInputDevice*> deviceList;
+};
+
+void WVirtualKeyboardManagerPrivate::addDevice(QWInputDevice *handle, WSeat *seat)
+{
+    W_Q(WVirtualKeyboardManager);
+    auto device = new WInputDevice(handle);
+    deviceList << device;
+
+    QObject::connect(handle, &QWInputDevice::beforeDestroy, q->server()->slotOwner(), [this, device] {
+        // Maybe is removed in WVirtualKeyboardManager::destroy
+        if (deviceList.removeOne(device))
+            removeDevice(device);
+    });
+
+    if (seat)
+        seat->attachInputDevice(device);
+    q->deviceAdded(device);
+}
+
+void WVirtualKeyboardManagerPrivate::removeDevice(WInputDevice *device)
+{
+    if (device->seat())
+        device->seat()->detachInputDevice(device);
+    q_func()->deviceRemoved(device);
+    delete device;
+}
+
+void WVirtualKeyboardManagerPrivate::on_new_keyboard(QWVirtualKeyboardV1 *keyboard)
+{
+    // The WSeat will set a default keymap for the new keyboard, it's
+    // replaced when the client sends its own keymap.
+    addDevice(QWKeyboard::from(&keyboard->handle()->keyboard), seat);
+}
+
+WVirtualKeyboardManager::WVirtualKeyboardManager(WSeat *seat)
+    : WObject(*new WVirtualKeyboardManagerPrivate(this, seat))
+{
+
+}
+
+WSeat *WVirtualKeyboardManager::seat() const
+{
+    W_DC(WVirtualKeyboardManager);
+    return d->seat;
+}
+
+QVector<WInputDevice*> WVirtualKeyboardManager::deviceList() const
+{
+    W_DC(WVirtualKeyboardManager);
+    return d->deviceList;
+}
+
+void WVirtualKeyboardManager::deviceAdded(WInputDevice *)
+{
+
+}
+
+void WVirtualKeyboardManager::deviceRemoved(WInputDevice *)
+{
+
+}
+
+void WVirtualKeyboardManager::create(WServer *server)
+{
+    // free follow display
+    auto manager = QWVirtualKeyboardManagerV1::create(server->handle());
+    Q_ASSERT(manager);
+    m_handle = manager;
+
+    QObject::connect(manager, &QWVirtualKeyboardManagerV1::newVirtualKeyboard, server->slotOwner(),
+                     [this] (QWVirtualKeyboardV1 *keyboard) {
+        d_func()->on_new_keyboard(keyboard);
+    });
+}
+
+void WVirtualKeyboardManager::destroy(WServer *server)
+{
+    Q_UNUSED(server);
+    W_D(WVirtualKeyboardManager);
+
+    auto list = d->deviceList;
+    d->deviceList.clear();
+
+    for (auto device : list)
+        d->removeDevice(device);
+
+    m_handle = nullptr;
+}
+
+WAYLIB_SERVER_END_NAMESPACE
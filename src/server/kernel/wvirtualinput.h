@@ -0,0 +1,51 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <WServer>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WSeat;
+class WInputDevice;
+class WVirtualPointerManagerPrivate;
+// wlr-virtual-pointer-unstable-v1, every virtual pointer is a WInputDevice
+// attached to the seat which is requested by client, or the default seat.
+class WAYLIB_SERVER_EXPORT WVirtualPointerManager : public WServerInterface, public WObject
+{
+    W_DECLARE_PRIVATE(WVirtualPointerManager)
+public:
+    WVirtualPointerManager(WSeat *seat);
+
+    WSeat *seat() const;
+    QVector<WInputDevice*> deviceList() const;
+
+protected:
+    virtual void deviceAdded(WInputDevice *device);
+    virtual void deviceRemoved(WInputDevice *device);
+
+    void create(WServer *server) override;
+    void destroy(WServer *server) override;
+};
+
+class WVirtualKeyboardManagerPrivate;
+// virtual-keyboard-unstable-v1, the keymap is provided by client.
+class WAYLIB_SERVER_EXPORT WVirtualKeyboardManager : public WServerInterface, public WObject
+{
+    W_DECLARE_PRIVATE(WVirtualKeyboardManager)
+public:
+    WVirtualKeyboardManager(WSeat *seat);
+
+    WSeat *seat() const;
+    QVector<WInputDevice*> deviceList() const;
+
+protected:
+    virtual void deviceAdded(WInputDevice *device);
+    virtual void deviceRemoved(WInputDevice *device);
+
+    void create(WServer *server) override;
+    void destroy(WServer *server) override;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -11,6 +11,8 @@
 #include <qwcompositor.h>
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 
 extern "C" {
 #define static
@@ -21,6 +23,8 @@ extern "C" {
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(qLcXdgSurface, "waylib.server.xdgsurface", QtWarningMsg)
+
 class Q_DECL_HIDDEN WXdgSurfacePrivate : public WObjectPrivate {
 public:
     WXdgSurfacePrivate(WXdgSurface *qq, QWXdgSurface *handle);
@@ -43,12 +47,20 @@ public:
     void init();
     void connect();
     void updatePosition();
+    void sendSize(const QSize &size);
 
     W_DECLARE_PUBLIC(WXdgSurface)
 
     QPointer<QWXdgSurface> handle;
     WSurface *surface = nullptr;
     QPointF position;
+    // Only one configure of size is in flight, the newer sizes
+    // replace the pending size until it's acked.
+    QSize pendingSize;
+    uint32_t sizeSerial = 0;
+    bool sizeInFlight = false;
+    int replacedSizes = 0;
+    QElapsedTimer sizeTimer;
     uint resizeing:1;
     uint activated:1;
     uint maximized:1;
@@ -96,8 +108,32 @@ void WXdgSurfacePrivate::on_configure(wlr_xdg_surface_configure *event)
 
 void WXdgSurfacePrivate::on_ack_configure(wlr_xdg_surface_configure *event)
 {
-    Q_UNUSED(event)
-//    auto config = reinterpret_cast<wlr_xdg_surface_configure*>(data);
+    // The serial is wrapping
+    if (!sizeInFlight || int32_t(event->serial - sizeSerial) < 0)
+        return;
+
+    sizeInFlight = false;
+    qCDebug(qLcXdgSurface) << "The size is acked after" << sizeTimer.elapsed()
+                           << "ms, replaced" << replacedSizes << "sizes";
+
+    if (pendingSize.isValid()) {
+        const QSize size = pendingSize;
+        pendingSize = QSize();
+        sendSize(size);
+    }
+}
+
+void WXdgSurfacePrivate::sendSize(const QSize &size)
+{
+    auto toplevel = handle->topToplevel();
+    Q_ASSERT(toplevel);
+
+    toplevel->setSize(size);
+    // The configure is scheduled, it's merged with the others before sent
+    sizeSerial = nativeHandle()->scheduled_serial;
+    sizeInFlight = true;
+    replacedSizes = 0;
+    sizeTimer.start();
 }
 
 void WXdgSurfacePrivate::init()
@@ -223,9 +259,23 @@ void WXdgSurface::resize(const QSize &size)
 {
     W_D(WXdgSurface);
 
-    if (auto toplevel = d->handle->topToplevel()) {
-        toplevel->setSize(size);
+    if (!d->handle->topToplevel())
+        return;
+
+    if (d->sizeInFlight) {
+        if (d->pendingSize.isValid())
+            ++d->replacedSizes;
+        d->pendingSize = size;
+        return;
     }
+
+    d->sendSize(size);
+}
+
+bool WXdgSurface::hasPendingSize() const
+{
+    W_DC(WXdgSurface);
+    return d->sizeInFlight || d->pendingSize.isValid();
 }
 
 bool WXdgSurface::isResizeing() const
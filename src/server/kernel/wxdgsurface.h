@@ -45,6 +45,8 @@ public:
     bool isActivated() const override;
     bool isMaximized() const override;
     bool isMinimized() const override;
+    // A size of resize() is not sent yet (throttled) or not acked by the client
+    bool hasPendingSize() const;
 
     QRect getContentGeometry() const override;
 
@@ -0,0 +1,436 @@
+// Copyright (C) 2023 JiDe Zhang <zccrs@live.com>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qwlrootseventdispatcher.h"
+
+#include <QSocketNotifier>
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <QPointer>
+#include <QVarLengthArray>
+#include <QDebug>
+
+#include <qpa/qwindowsysteminterface.h>
+#include <private/qthread_p.h>
+#include <private/qcoreapplication_p.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+#include <wayland-server-core.h>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// Enable the debug message to print the count of wakeups per second
+Q_LOGGING_CATEGORY(qLcEventDispatcher, "waylib.server.eventdispatcher", QtWarningMsg)
+
+QWlrootsEventDispatcher::QWlrootsEventDispatcher(QObject *parent)
+    : QAbstractEventDispatcher(parent)
+    , m_epollFd(epoll_create1(EPOLL_CLOEXEC))
+    , m_wakeUpFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+    Q_ASSERT(m_epollFd >= 0 && m_wakeUpFd >= 0);
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = m_wakeUpFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeUpFd, &event);
+
+    m_lastLogTime = Clock::now();
+}
+
+QWlrootsEventDispatcher::~QWlrootsEventDispatcher()
+{
+    close(m_wakeUpFd);
+    close(m_epollFd);
+}
+
+void QWlrootsEventDispatcher::setWaylandDisplay(wl_display *display)
+{
+    if (m_display == display)
+        return;
+
+    if (m_loopFd >= 0)
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_loopFd, nullptr);
+
+    m_display = display;
+    m_loop = display ? wl_display_get_event_loop(display) : nullptr;
+    m_loopFd = m_loop ? wl_event_loop_get_fd(m_loop) : -1;
+
+    if (m_loopFd >= 0) {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = m_loopFd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_loopFd, &event);
+    }
+}
+
+wl_display *QWlrootsEventDispatcher::waylandDisplay() const
+{
+    return m_display;
+}
+
+void QWlrootsEventDispatcher::setFlushClientsHandler(std::function<void ()> handler)
+{
+    m_flushHandler = handler;
+}
+
+const QWlrootsEventDispatcher::Statistics &QWlrootsEventDispatcher::statistics() const
+{
+    return m_statistics;
+}
+
+bool QWlrootsEventDispatcher::processEvents(QEventLoop::ProcessEventsFlags flags)
+{
+    m_interrupt.storeRelaxed(0);
+    Q_EMIT awake();
+
+    auto threadData = QThreadData::current();
+    QCoreApplicationPrivate::sendPostedEvents(nullptr, 0, threadData);
+
+    const bool includeTimers = !flags.testFlag(QEventLoop::X11ExcludeTimers);
+    const bool includeNotifiers = !flags.testFlag(QEventLoop::ExcludeSocketNotifiers);
+    const bool canWait = flags.testFlag(QEventLoop::WaitForMoreEvents)
+        && threadData->canWaitLocked() && !m_interrupt.loadRelaxed();
+
+    if (m_loop) {
+        // The idle sources of wl_event_loop don't wake up its fd
+        wl_event_loop_dispatch_idle(m_loop);
+    }
+
+    if (canWait) {
+        Q_EMIT aboutToBlock();
+        flushClients();
+    }
+
+    if (m_interrupt.loadRelaxed())
+        return false;
+
+    int timeout = 0;
+    if (canWait) {
+        timeout = includeTimers ? timerWait() : -1;
+        // Maybe a event is posted in aboutToBlock
+        if (!threadData->canWaitLocked())
+            timeout = 0;
+    }
+
+    epoll_event events[32];
+    int count = epoll_wait(m_epollFd, events, std::size(events), timeout);
+    if (count < 0) {
+        if (errno != EINTR)
+            qCWarning(qLcEventDispatcher) << "epoll_wait failed:" << strerror(errno);
+        count = 0;
+    }
+
+    if (canWait) {
+        ++m_statistics.wakeups;
+        Q_EMIT awake();
+    }
+
+    int nevents = 0;
+    bool dispatchWayland = false;
+    QList<QPointer<QSocketNotifier>> activated;
+
+    for (int i = 0; i < count; ++i) {
+        const int fd = events[i].data.fd;
+        const uint32_t revents = events[i].events;
+
+        if (fd == m_wakeUpFd) {
+            eventfd_t value;
+            eventfd_read(m_wakeUpFd, &value);
+            m_wakeUps.storeRelease(0);
+            continue;
+        }
+
+        if (fd == m_loopFd) {
+            dispatchWayland = true;
+            continue;
+        }
+
+        if (!includeNotifiers)
+            continue;
+
+        auto it = m_notifiers.constFind(fd);
+        if (it == m_notifiers.constEnd())
+            continue;
+
+        if (it->read && (revents & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+            activated << it->read;
+        if (it->write && (revents & (EPOLLOUT | EPOLLHUP | EPOLLERR)))
+            activated << it->write;
+        if (it->exception && (revents & EPOLLPRI))
+            activated << it->exception;
+    }
+
+    if (dispatchWayland) {
+        ++nevents;
+        ++m_statistics.waylandDispatches;
+        int ret = wl_event_loop_dispatch(m_loop, 0);
+        if (ret)
+            qCWarning(qLcEventDispatcher) << "wl_event_loop_dispatch error:" << ret;
+    }
+
+    for (const auto &notifier : std::as_const(activated)) {
+        if (!notifier)
+            continue;
+        activateNotifier(notifier);
+        ++nevents;
+    }
+
+    if (includeTimers)
+        nevents += activateTimers();
+
+    const bool windowSystemEvents = QWindowSystemInterface::sendWindowSystemEvents(flags);
+
+    if (!canWait) {
+        // The wayland events are flushed before block, but if the loop
+        // doesn't block, still need to flush after handled these events.
+        flushClients();
+    }
+
+    if (qLcEventDispatcher().isDebugEnabled())
+        logStatistics();
+
+    return nevents > 0 || windowSystemEvents;
+}
+
+void QWlrootsEventDispatcher::registerSocketNotifier(QSocketNotifier *notifier)
+{
+    Q_ASSERT(notifier);
+    const int fd = int(notifier->socket());
+
+    auto it = m_notifiers.find(fd);
+    const int op = it == m_notifiers.end() ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    if (it == m_notifiers.end())
+        it = m_notifiers.insert(fd, {});
+
+    switch (notifier->type()) {
+    case QSocketNotifier::Read:
+        it->read = notifier;
+        break;
+    case QSocketNotifier::Write:
+        it->write = notifier;
+        break;
+    case QSocketNotifier::Exception:
+        it->exception = notifier;
+        break;
+    }
+
+    updateEpoll(fd, *it, op);
+}
+
+void QWlrootsEventDispatcher::unregisterSocketNotifier(QSocketNotifier *notifier)
+{
+    Q_ASSERT(notifier);
+    const int fd = int(notifier->socket());
+
+    auto it = m_notifiers.find(fd);
+    if (it == m_notifiers.end())
+        return;
+
+    if (it->read == notifier)
+        it->read = nullptr;
+    else if (it->write == notifier)
+        it->write = nullptr;
+    else if (it->exception == notifier)
+        it->exception = nullptr;
+
+    if (!it->read && !it->write && !it->exception) {
+        m_notifiers.erase(it);
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    } else {
+        updateEpoll(fd, *it, EPOLL_CTL_MOD);
+    }
+}
+
+void QWlrootsEventDispatcher::registerTimer(int timerId, qint64 interval, Qt::TimerType timerType, QObject *object)
+{
+    Q_ASSERT(timerId > 0 && interval >= 0 && object);
+
+    // The VeryCoarseTimer is rounded to full seconds
+    if (timerType == Qt::VeryCoarseTimer)
+        interval = qMax<qint64>(1000, (interval + 500) / 1000 * 1000);
+
+    m_timers.append({timerId, interval, timerType, object,
+                     Clock::now() + std::chrono::milliseconds(interval)});
+}
+
+bool QWlrootsEventDispatcher::unregisterTimer(int timerId)
+{
+    for (int i = 0; i < m_timers.size(); ++i) {
+        if (m_timers.at(i).id == timerId) {
+            m_timers.removeAt(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool QWlrootsEventDispatcher::unregisterTimers(QObject *object)
+{
+    return m_timers.removeIf([object] (const Timer &timer) {
+        return timer.object == object;
+    }) > 0;
+}
+
+QList<QAbstractEventDispatcher::TimerInfo> QWlrootsEventDispatcher::registeredTimers(QObject *object) const
+{
+    QList<TimerInfo> list;
+    for (const auto &timer : m_timers) {
+        if (timer.object == object)
+            list.append(TimerInfo(timer.id, int(timer.interval), timer.type));
+    }
+
+    return list;
+}
+
+int QWlrootsEventDispatcher::remainingTime(int timerId)
+{
+    const auto now = Clock::now();
+    for (const auto &timer : std::as_const(m_timers)) {
+        if (timer.id != timerId)
+            continue;
+        if (timer.timeout <= now)
+            return 0;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(timer.timeout - now).count();
+    }
+
+    return -1;
+}
+
+void QWlrootsEventDispatcher::wakeUp()
+{
+    // Avoid to write the eventfd repeatedly before it's read
+    if (m_wakeUps.testAndSetAcquire(0, 1))
+        eventfd_write(m_wakeUpFd, 1);
+}
+
+void QWlrootsEventDispatcher::interrupt()
+{
+    m_interrupt.storeRelaxed(1);
+    wakeUp();
+}
+
+void QWlrootsEventDispatcher::updateEpoll(int fd, const Notifiers &notifiers, int op)
+{
+    epoll_event event = {};
+    if (notifiers.read)
+        event.events |= EPOLLIN;
+    if (notifiers.write)
+        event.events |= EPOLLOUT;
+    if (notifiers.exception)
+        event.events |= EPOLLPRI;
+    event.data.fd = fd;
+
+    if (epoll_ctl(m_epollFd, op, fd, &event) < 0)
+        qCWarning(qLcEventDispatcher) << "epoll_ctl failed for fd" << fd << strerror(errno);
+}
+
+int QWlrootsEventDispatcher::timerWait() const
+{
+    if (m_timers.isEmpty())
+        return -1;
+
+    auto timeout = Clock::time_point::max();
+    for (const auto &timer : m_timers) {
+        if (!timer.activating && timer.timeout < timeout)
+            timeout = timer.timeout;
+    }
+
+    if (timeout == Clock::time_point::max())
+        return -1;
+
+    const auto now = Clock::now();
+    if (timeout <= now)
+        return 0;
+
+    // Round up, don't wake up before the timer is timeout
+    const auto wait = std::chrono::ceil<std::chrono::milliseconds>(timeout - now);
+    return int(qMin<qint64>(wait.count(), std::numeric_limits<int>::max()));
+}
+
+int QWlrootsEventDispatcher::activateTimers()
+{
+    const auto now = Clock::now();
+    QVarLengthArray<int, 16> expired;
+
+    for (const auto &timer : std::as_const(m_timers)) {
+        if (!timer.activating && timer.timeout <= now)
+            expired.append(timer.id);
+    }
+
+    int count = 0;
+    for (int id : std::as_const(expired)) {
+        // The timers list maybe changed in the previous timer event
+        auto it = std::find_if(m_timers.begin(), m_timers.end(), [id] (const Timer &timer) {
+            return timer.id == id;
+        });
+        if (it == m_timers.end() || it->activating)
+            continue;
+
+        const auto interval = std::chrono::milliseconds(it->interval);
+        it->timeout += interval;
+        if (it->timeout <= now)
+            it->timeout = now + interval;
+        it->activating = true;
+
+        QObject *object = it->object;
+        QTimerEvent event(id);
+        QCoreApplication::sendEvent(object, &event);
+        ++count;
+
+        it = std::find_if(m_timers.begin(), m_timers.end(), [id] (const Timer &timer) {
+            return timer.id == id;
+        });
+        if (it != m_timers.end())
+            it->activating = false;
+    }
+
+    return count;
+}
+
+void QWlrootsEventDispatcher::activateNotifier(QSocketNotifier *notifier)
+{
+    QEvent event(QEvent::SockAct);
+    QCoreApplication::sendEvent(notifier, &event);
+}
+
+void QWlrootsEventDispatcher::flushClients()
+{
+    if (!m_display)
+        return;
+
+    // libwayland only writes the clients which have buffered events
+    ++m_statistics.flushes;
+
+    if (m_flushHandler)
+        m_flushHandler();
+    else
+        wl_display_flush_clients(m_display);
+}
+
+void QWlrootsEventDispatcher::logStatistics()
+{
+    const auto now = Clock::now();
+    const auto elapsed = std::chrono::duration<double>(now - m_lastLogTime).count();
+    if (elapsed < 1.0)
+        return;
+
+    qCDebug(qLcEventDispatcher).nospace()
+        << "wakeups/s: " << (m_statistics.wakeups - m_lastStatistics.wakeups) / elapsed
+        << ", wayland dispatches/s: " << (m_statistics.waylandDispatches - m_lastStatistics.waylandDispatches) / elapsed
+        << ", flushes/s: " << (m_statistics.flushes - m_lastStatistics.flushes) / elapsed;
+
+    m_lastStatistics = m_statistics;
+    m_lastLogTime = now;
+}
+
+WAYLIB_SERVER_END_NAMESPACE
+
+#include "moc_qwlrootseventdispatcher.cpp"
@@ -0,0 +1,100 @@
+// Copyright (C) 2023 JiDe Zhang <zccrs@live.com>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include "wglobal.h"
+
+#include <QAbstractEventDispatcher>
+#include <QHash>
+#include <QAtomicInt>
+
+#include <chrono>
+#include <functional>
+
+struct wl_display;
+struct wl_event_loop;
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// An epoll based event dispatcher, the wl_event_loop's fd is a source of it
+// like the socket notifiers, so the wayland events are dispatched only when the
+// fd is readable instead of on every loop iteration, and the clients are flushed
+// once before the dispatcher blocks.
+class Q_DECL_HIDDEN QWlrootsEventDispatcher : public QAbstractEventDispatcher
+{
+    Q_OBJECT
+public:
+    explicit QWlrootsEventDispatcher(QObject *parent = nullptr);
+    ~QWlrootsEventDispatcher();
+
+    void setWaylandDisplay(wl_display *display);
+    wl_display *waylandDisplay() const;
+    // Replace the default wl_display_flush_clients
+    void setFlushClientsHandler(std::function<void()> handler);
+
+    struct Statistics {
+        quint64 wakeups = 0;
+        quint64 waylandDispatches = 0;
+        quint64 flushes = 0;
+    };
+    const Statistics &statistics() const;
+
+    bool processEvents(QEventLoop::ProcessEventsFlags flags) override;
+
+    void registerSocketNotifier(QSocketNotifier *notifier) override;
+    void unregisterSocketNotifier(QSocketNotifier *notifier) override;
+
+    void registerTimer(int timerId, qint64 interval, Qt::TimerType timerType, QObject *object) override;
+    bool unregisterTimer(int timerId) override;
+    bool unregisterTimers(QObject *object) override;
+    QList<TimerInfo> registeredTimers(QObject *object) const override;
+    int remainingTime(int timerId) override;
+
+    void wakeUp() override;
+    void interrupt() override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        int id;
+        qint64 interval;
+        Qt::TimerType type;
+        QObject *object;
+        Clock::time_point timeout;
+        bool activating = false;
+    };
+
+    struct Notifiers {
+        QSocketNotifier *read = nullptr;
+        QSocketNotifier *write = nullptr;
+        QSocketNotifier *exception = nullptr;
+    };
+
+    void updateEpoll(int fd, const Notifiers &notifiers, int op);
+    int timerWait() const;
+    int activateTimers();
+    void activateNotifier(QSocketNotifier *notifier);
+    void flushClients();
+    void logStatistics();
+
+    int m_epollFd = -1;
+    int m_wakeUpFd = -1;
+    QAtomicInt m_interrupt;
+    QAtomicInt m_wakeUps;
+
+    wl_display *m_display = nullptr;
+    wl_event_loop *m_loop = nullptr;
+    int m_loopFd = -1;
+    std::function<void()> m_flushHandler;
+
+    QHash<int, Notifiers> m_notifiers;
+    QList<Timer> m_timers;
+
+    Statistics m_statistics;
+    Statistics m_lastStatistics;
+    Clock::time_point m_lastLogTime;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
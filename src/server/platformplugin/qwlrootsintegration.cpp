@@ -9,6 +9,7 @@
 #include "qwlrootsintegration.h"
 #include "qwlrootscreen.h"
 #include "qwlrootswindow.h"
+#include "qwlrootseventdispatcher.h"
 #include "woutput.h"
 #include "winputdevice.h"
 #include "types.h"
@@ -430,7 +431,12 @@ QOpenGLContext::OpenGLModuleType QWlrootsIntegration::openGLModuleType()
 
 QAbstractEventDispatcher *QWlrootsIntegration::createEventDispatcher() const
 {
-    return CALL_PROXY2(createEventDispatcher, createUnixEventDispatcher());
+    if (m_proxyIntegration)
+        return m_proxyIntegration->createEventDispatcher();
+    // For compare the performance with the default event dispatcher of Qt
+    if (qEnvironmentVariableIsSet("WAYLIB_DISABLE_EPOLL_DISPATCHER"))
+        return createUnixEventDispatcher();
+    return new QWlrootsEventDispatcher();
 }
 
 QPlatformNativeInterface *QWlrootsIntegration::nativeInterface() const
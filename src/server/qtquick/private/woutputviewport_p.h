@@ -9,8 +9,11 @@
 
 #include <qwoutput.h>
 #include <qwtexture.h>
+#include <qwxcursormanager.h>
 
 #include <QQuickTextureFactory>
+#include <QSet>
+#include <QVariantAnimation>
 #include <private/qquickitem_p.h>
 
 extern "C" {
@@ -59,6 +62,50 @@ public:
     QQuickTextureFactory *requestTexture(const QString &id, QSize *size, const QSize &requestedSize) override;
 };
 
+struct CursorTextureKey
+{
+    QByteArray theme;
+    quint32 size = 0;
+    QByteArray name;
+    float scale = 0;
+    int frame = 0;
+
+    inline bool operator==(const CursorTextureKey &other) const {
+        return theme == other.theme && size == other.size && name == other.name
+            && qFuzzyCompare(scale, other.scale) && frame == other.frame;
+    }
+};
+
+inline size_t qHash(const CursorTextureKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.theme, key.size, key.name, key.scale, key.frame);
+}
+
+// The textures of the xcursor images in a window, they are shared by all the
+// cursors and never recreated on the shape changes. The images are from the
+// WXCursorThemeCache, and all frames of the common shapes of a theme are
+// created once the theme is decoded at a scale.
+class CursorTextureCache : public QObject
+{
+public:
+    static CursorTextureCache *get(QQuickWindow *window);
+
+    QSGTexture *texture(QWXCursorManager *manager, const QByteArray &name, float scale, int frame = 0);
+
+private:
+    explicit CursorTextureCache(QQuickWindow *window);
+    ~CursorTextureCache();
+
+    void preload(QWXCursorManager *manager, float scale);
+    QSGTexture *load(QWXCursorManager *manager, const CursorTextureKey &key);
+    void clear();
+
+    QQuickWindow *m_window;
+    QHash<CursorTextureKey, QSGTexture*> m_textures;
+    // The key without name
+    QSet<CursorTextureKey> m_preloaded;
+};
+
 class QuickOutputCursor : public QObject
 {
     friend class WOutputViewportPrivate;
@@ -83,6 +130,11 @@ public:
     QUrl imageSource() const;
     QSizeF size() const;
     QRectF sourceRect() const;
+    QWTexture *texture() const;
+    // Not null if the image is known as a xcursor
+    QWXCursorManager *xcursorManager() const;
+    QByteArray xcursorName() const;
+    float xcursorScale() const;
 
 Q_SIGNALS:
     void visibleChanged();
@@ -91,6 +143,7 @@ Q_SIGNALS:
     void imageSourceChanged();
     void sizeChanged();
     void sourceRectChanged();
+    void xcursorChanged();
 
 private:
     void setVisible(bool newVisible);
@@ -102,6 +155,7 @@ private:
     void setSourceRect(const QRectF &newSourceRect);
     void setPosition(const QPointF &pos);
     void setDelegateItem(QQuickItem *item);
+    void setXCursor(QWXCursorManager *manager, const QByteArray &name, float scale);
 
     QQuickItem *delegateItem = nullptr;
     wlr_texture *lastTexture = nullptr;
@@ -111,6 +165,9 @@ private:
     QUrl m_imageSource;
     QSizeF m_size;
     QRectF m_sourceRect;
+    QWXCursorManager *m_xcursorManager = nullptr;
+    QByteArray m_xcursorName;
+    float m_xcursorScale = 1.0;
 
     struct TextureAttrib {
         TextureAttrib (): type(INVALID) {}
@@ -143,6 +200,43 @@ private:
     } lastTextureAttrib;
 };
 
+// Used if the cursorDelegate is null, the cursor texture is drawn by a
+// QSGImageNode on the top of the scene. If only the cursors are changed,
+// only their old and new rectangles are damaged in the outputs, instead of
+// all the outputs, see WOutputRenderWindowPrivate::collectCursorDamage.
+class OutputCursorItem : public QQuickItem
+{
+public:
+    explicit OutputCursorItem(QuickOutputCursor *cursor, QQuickItem *parent);
+    ~OutputCursorItem();
+
+    static inline OutputCursorItem *from(QQuickItem *item) {
+        return dynamic_cast<OutputCursorItem*>(item);
+    }
+    static const QList<OutputCursorItem*> &instances();
+
+    // The rectangles in the scene of the last rendered and the current,
+    // called before rendering
+    QRegion takeDamage();
+
+private:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override;
+    QRectF cursorRect() const;
+    void updateVisible();
+    // The frames of animated xcursor are advanced by the QAbstractAnimation,
+    // it's driven by the frames of outputs, see WOutputRenderWindow
+    void updateAnimation();
+    void setFrameTime(int time);
+
+    QuickOutputCursor *m_cursor;
+    QRect m_lastRect;
+    bool m_textureDirty = true;
+
+    QList<int> m_frameDelays;
+    int m_frame = 0;
+    QVariantAnimation *m_animation = nullptr;
+};
+
 class WOutputViewportPrivate : public QQuickItemPrivate
 {
 public:
@@ -154,6 +248,10 @@ public:
         clearCursors();
     }
 
+    inline static WOutputViewportPrivate *get(WOutputViewport *qq) {
+        return qq->d_func();
+    }
+
     inline WOutputRenderWindow *outputWindow() const {
         auto ow = qobject_cast<WOutputRenderWindow*>(window);
         Q_ASSERT(ow);
@@ -177,6 +275,10 @@ public:
     WQuickSeat *seat = nullptr;
     qreal devicePixelRatio = 1.0;
     QQmlComponent *cursorDelegate = nullptr;
+    bool predictiveFrameCallback = false;
+    bool delayRender = false;
+    int renderSafetyMargin = 2;
+    qint64 nextRenderTime = 0;
     QList<QuickOutputCursor*> cursors;
     QMetaObject::Connection updateCursorsConnection;
 };
@@ -2,14 +2,134 @@
 // SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "wqmldynamiccreator_p.h"
+#include "woutputrenderwindow.h"
 
 #include <QJSValue>
 #include <QQuickItem>
 #include <QQmlInfo>
+#include <QQmlEngine>
+#include <QQmlProperty>
+#include <QTimer>
+#include <QGuiApplication>
 #include <private/qqmlcomponent_p.h>
+#include <private/qquickitem_p.h>
+
+#include <time.h>
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+// Used if the QQmlEngine hasn't an incubation controller, otherwise the
+// incubation is synchronous. Incubate after the render pass of the output
+// render windows, in the time left until the next render starts (at most
+// budget msecs), so it doesn't delay the render of next frame.
+class WQmlIncubationController : public QObject, public QQmlIncubationController
+{
+public:
+    explicit WQmlIncubationController(QQmlEngine *engine)
+        : QObject(engine)
+    {
+        // Nothing is rendering, e.g. the outputs are idle, drive by a render pass
+        idleTimer.setInterval(16);
+        idleTimer.setSingleShot(true);
+        connect(&idleTimer, &QTimer::timeout, this, &WQmlIncubationController::scheduleRender);
+    }
+
+    static WQmlIncubationController *ensure(QQmlEngine *engine) {
+        if (auto controller = engine->incubationController())
+            return dynamic_cast<WQmlIncubationController*>(controller);
+
+        auto controller = new WQmlIncubationController(engine);
+        engine->setIncubationController(controller);
+        return controller;
+    }
+
+    int budget = 5;
+
+protected:
+    void incubatingObjectCountChanged(int count) override {
+        if (count > 0 && !idleTimer.isActive())
+            scheduleRender();
+        else if (count == 0)
+            idleTimer.stop();
+    }
+
+private:
+    void scheduleRender() {
+        const auto windows = QGuiApplication::allWindows();
+        for (auto window : windows) {
+            auto renderWindow = qobject_cast<WOutputRenderWindow*>(window);
+            if (!renderWindow)
+                continue;
+            connect(renderWindow, &WOutputRenderWindow::renderFinished,
+                    this, &WQmlIncubationController::onRenderFinished, Qt::UniqueConnection);
+            renderWindow->scheduleRender();
+        }
+
+        idleTimer.start();
+    }
+
+    void onRenderFinished() {
+        if (incubatingObjectCount() == 0)
+            return;
+
+        int msecs = budget;
+        auto window = static_cast<WOutputRenderWindow*>(sender());
+        if (const qint64 renderTime = window->nextRenderTime()) {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            // Leave 1ms for the events before the render
+            const qint64 left = (renderTime - (now.tv_sec * 1000000000ll + now.tv_nsec)) / 1000000 - 1;
+            msecs = qBound<qint64>(0, left, budget);
+        }
+
+        if (msecs > 0)
+            incubateFor(msecs);
+
+        if (incubatingObjectCount() > 0)
+            idleTimer.start();
+    }
+
+    QTimer idleTimer;
+};
+
+class WQmlCreatorIncubator : public QQmlIncubator
+{
+public:
+    WQmlCreatorIncubator(WQmlCreatorComponent *component, QWeakPointer<WQmlCreatorDelegateData> data,
+                         QObject *parent)
+        : QQmlIncubator(Asynchronous)
+        , component(component)
+        , data(data)
+        , parent(parent)
+    {
+
+    }
+
+    QObject *parentObject() const {
+        return parent;
+    }
+
+protected:
+    void setInitialState(QObject *object) override {
+        object->setParent(parent);
+        // The parentItem is set when it's ready, the incomplete object is not
+        // in the scene, so it doesn't take the input or affect the layout. But
+        // the delegate maybe binds its own parent, don't render it at least.
+        if (auto item = qobject_cast<QQuickItem*>(object))
+            QQuickItemPrivate::get(item)->setCulled(true);
+    }
+
+    void statusChanged(Status status) override {
+        if (auto d = data.toStrongRef())
+            component->onIncubatorStatusChanged(d, status);
+    }
+
+private:
+    WQmlCreatorComponent *component;
+    QWeakPointer<WQmlCreatorDelegateData> data;
+    QPointer<QObject> parent;
+};
+
 WAbstractCreatorComponent::WAbstractCreatorComponent(QObject *parent)
     : QObject(parent)
 {
@@ -97,6 +217,9 @@ WQmlCreatorComponent::~WQmlCreatorComponent()
         m_creator->removeDelegate(this);
 
     clear();
+
+    m_poolSize = 0;
+    trimPool();
 }
 
 bool WQmlCreatorComponent::checkByChooser(const QJSValue &properties) const
@@ -146,6 +269,9 @@ void WQmlCreatorComponent::remove(QSharedPointer<WQmlCreatorData> data)
 
 void WQmlCreatorComponent::destroy(QSharedPointer<WQmlCreatorDelegateData> data)
 {
+    // Abort the incubation, the incomplete object is deleted
+    data->incubator.reset();
+
     if (data->object) {
         auto obj = data->object.get();
         data->object.clear();
@@ -153,7 +279,7 @@ void WQmlCreatorComponent::destroy(QSharedPointer<WQmlCreatorDelegateData> data)
         Q_EMIT objectRemoved(obj, p);
         notifyCreatorObjectRemoved(m_creator, obj, p);
 
-        if (m_autoDestroy)
+        if (m_autoDestroy && !recycle(obj, p.toVariant().toMap().keys()))
             obj->deleteLater();
     }
 }
@@ -225,6 +351,18 @@ void WQmlCreatorComponent::create(QSharedPointer<WQmlCreatorDelegateData> data,
     // you will get a null pointer if you using after it's destroyed.
     const auto tmp = qvariant_cast<QVariantMap>(initialProperties.toVariant());
 
+    if (auto object = reuse(parent, tmp)) {
+        data->object = object;
+        Q_EMIT objectAdded(object, initialProperties);
+        notifyCreatorObjectAdded(m_creator, object, initialProperties);
+        return;
+    }
+
+    if (m_asynchronous) {
+        incubate(data, parent, tmp);
+        return;
+    }
+
 #if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
     data->object = d->createWithProperties(parent, tmp, qmlContext(this));
 #else
@@ -262,6 +400,110 @@ void WQmlCreatorComponent::create(QSharedPointer<WQmlCreatorDelegateData> data,
     }
 }
 
+void WQmlCreatorComponent::incubate(QSharedPointer<WQmlCreatorDelegateData> data, QObject *parent,
+                                    const QVariantMap &initialProperties)
+{
+    if (auto controller = WQmlIncubationController::ensure(qmlEngine(this)))
+        controller->budget = m_incubationBudget;
+
+    auto incubator = new WQmlCreatorIncubator(this, data.toWeakRef(), parent);
+    incubator->setInitialProperties(initialProperties);
+    data->incubator.reset(incubator);
+    m_delegate->create(*incubator, qmlContext(this));
+}
+
+void WQmlCreatorComponent::onIncubatorStatusChanged(QSharedPointer<WQmlCreatorDelegateData> data,
+                                                    QQmlIncubator::Status status)
+{
+    Q_ASSERT(data->incubator);
+
+    if (status == QQmlIncubator::Error) {
+        qmlWarning(this, data->incubator->errors());
+        return;
+    }
+
+    if (status != QQmlIncubator::Ready)
+        return;
+
+    auto object = data->incubator->object();
+    if (auto item = qobject_cast<QQuickItem*>(object)) {
+        if (!item->parentItem()) {
+            auto parent = static_cast<WQmlCreatorIncubator*>(data->incubator.get())->parentObject();
+            item->setParentItem(qobject_cast<QQuickItem*>(parent));
+        }
+        QQuickItemPrivate::get(item)->setCulled(false);
+    }
+    data->object = object;
+
+    const QJSValue p = data->data.lock()->properties;
+    Q_EMIT objectAdded(object, p);
+    notifyCreatorObjectAdded(m_creator, object, p);
+}
+
+bool WQmlCreatorComponent::recycle(QObject *object, const QStringList &properties)
+{
+    if (m_pool.size() >= m_poolSize)
+        return false;
+
+    // Remove from the scene, it doesn't render or take the input
+    if (auto item = qobject_cast<QQuickItem*>(object)) {
+        item->setFocus(false);
+        item->setParentItem(nullptr);
+        item->setVisible(false);
+        item->setEnabled(false);
+    }
+    m_pool.append({object, properties});
+
+    return true;
+}
+
+QObject *WQmlCreatorComponent::reuse(QObject *parent, const QVariantMap &initialProperties)
+{
+    PooledObject pooled;
+    while (!pooled.object && !m_pool.isEmpty())
+        pooled = m_pool.takeLast();
+
+    QObject *object = pooled.object.get();
+    if (!object)
+        return nullptr;
+
+    object->setParent(parent);
+    auto item = qobject_cast<QQuickItem*>(object);
+    // Before the initial properties, they maybe contains visible or enabled
+    if (item) {
+        item->setVisible(true);
+        item->setEnabled(true);
+    }
+
+    auto context = qmlContext(object);
+    for (const auto &name : std::as_const(pooled.properties)) {
+        if (initialProperties.contains(name))
+            continue;
+        QQmlProperty property(object, name, context);
+        if (!property.reset())
+            qmlWarning(object) << "Can't reset the property" << name << "of the reused object, "
+                                  "it's absent in the new initial properties";
+    }
+
+    for (auto it = initialProperties.constBegin(); it != initialProperties.constEnd(); ++it) {
+        if (!QQmlProperty::write(object, it.key(), it.value(), context))
+            qmlWarning(object) << "Can't reset the property" << it.key() << "of the reused object";
+    }
+
+    if (item)
+        item->setParentItem(qobject_cast<QQuickItem*>(parent));
+
+    return object;
+}
+
+void WQmlCreatorComponent::trimPool()
+{
+    while (m_pool.size() > m_poolSize) {
+        if (auto object = m_pool.takeLast().object)
+            object->deleteLater();
+    }
+}
+
 QObject *WQmlCreatorComponent::parent() const
 {
     return m_parent;
@@ -329,6 +571,53 @@ void WQmlCreatorComponent::setAutoDestroy(bool newAutoDestroy)
     Q_EMIT autoDestroyChanged();
 }
 
+bool WQmlCreatorComponent::asynchronous() const
+{
+    return m_asynchronous;
+}
+
+void WQmlCreatorComponent::setAsynchronous(bool newAsynchronous)
+{
+    if (m_asynchronous == newAsynchronous)
+        return;
+    m_asynchronous = newAsynchronous;
+    Q_EMIT asynchronousChanged();
+}
+
+int WQmlCreatorComponent::incubationBudget() const
+{
+    return m_incubationBudget;
+}
+
+void WQmlCreatorComponent::setIncubationBudget(int newIncubationBudget)
+{
+    if (newIncubationBudget <= 0) {
+        qmlWarning(this) << "The incubationBudget must be greater than 0";
+        return;
+    }
+
+    if (m_incubationBudget == newIncubationBudget)
+        return;
+    m_incubationBudget = newIncubationBudget;
+    Q_EMIT incubationBudgetChanged();
+}
+
+int WQmlCreatorComponent::poolSize() const
+{
+    return m_poolSize;
+}
+
+void WQmlCreatorComponent::setPoolSize(int newPoolSize)
+{
+    newPoolSize = qMax(0, newPoolSize);
+    if (m_poolSize == newPoolSize)
+        return;
+    m_poolSize = newPoolSize;
+    trimPool();
+
+    Q_EMIT poolSizeChanged();
+}
+
 WQmlCreator::WQmlCreator(QObject *parent)
     : QObject{parent}
 {
@@ -6,6 +6,9 @@
 #include <wglobal.h>
 #include <QList>
 #include <QQmlComponent>
+#include <QQmlIncubator>
+
+#include <memory>
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
@@ -13,6 +16,8 @@ struct WQmlCreatorData;
 struct Q_DECL_HIDDEN WQmlCreatorDelegateData {
     QPointer<QObject> object;
     QWeakPointer<WQmlCreatorData> data;
+    // Not null if the object is in incubating
+    std::unique_ptr<QQmlIncubator> incubator;
 };
 
 class WAbstractCreatorComponent;
@@ -75,6 +80,9 @@ class WAYLIB_SERVER_EXPORT WQmlCreatorComponent : public WAbstractCreatorCompone
     Q_PROPERTY(QString chooserRole READ chooserRole WRITE setChooserRole NOTIFY chooserRoleChanged FINAL)
     Q_PROPERTY(QVariant chooserRoleValue READ chooserRoleValue WRITE setChooserRoleValue NOTIFY chooserRoleValueChanged FINAL)
     Q_PROPERTY(bool autoDestroy READ autoDestroy WRITE setAutoDestroy NOTIFY autoDestroyChanged FINAL)
+    Q_PROPERTY(bool asynchronous READ asynchronous WRITE setAsynchronous NOTIFY asynchronousChanged FINAL)
+    Q_PROPERTY(int incubationBudget READ incubationBudget WRITE setIncubationBudget NOTIFY incubationBudgetChanged FINAL)
+    Q_PROPERTY(int poolSize READ poolSize WRITE setPoolSize NOTIFY poolSizeChanged FINAL)
     QML_NAMED_ELEMENT(DynamicCreatorComponent)
     Q_CLASSINFO("DefaultProperty", "delegate")
 
@@ -96,6 +104,27 @@ public:
     bool autoDestroy() const;
     void setAutoDestroy(bool newAutoDestroy);
 
+    // Create the objects by QQmlIncubator, they are completed in the
+    // next frames and hidden in the scene until they are ready.
+    bool asynchronous() const;
+    void setAsynchronous(bool newAsynchronous);
+
+    // The max msecs of incubating in a frame, it's incubating after the render
+    // of outputs until the next render starts. Only used if the QQmlEngine
+    // hasn't an incubation controller.
+    int incubationBudget() const;
+    void setIncubationBudget(int newIncubationBudget);
+
+    // Keep at most poolSize removed objects if autoDestroy is enabled, and
+    // reuse them for the new data by writing the initial properties again.
+    // The pooled item is removed from the scene (no parentItem, invisible,
+    // disabled and without focus), visible and enabled are reset to true
+    // when it's reused. The properties of the previous data absent in the
+    // new data are reset, it's a warning if they have no RESET function.
+    // The delegate should not keep other states.
+    int poolSize() const;
+    void setPoolSize(int newPoolSize);
+
     QObject *parent() const;
     void setParent(QObject *newParent);
 
@@ -108,6 +137,9 @@ Q_SIGNALS:
     void chooserRoleChanged();
     void chooserRoleValueChanged();
     void autoDestroyChanged();
+    void asynchronousChanged();
+    void incubationBudgetChanged();
+    void poolSizeChanged();
 
     void objectAdded(QObject *object, const QJSValue &initialProperties);
     void objectRemoved(QObject *object, const QJSValue &initialProperties);
@@ -123,12 +155,28 @@ private:
     void reset();
     void create(QSharedPointer<WQmlCreatorDelegateData> data);
     Q_SLOT void create(QSharedPointer<WQmlCreatorDelegateData> data, QObject *parent, const QJSValue &initialProperties);
+    void incubate(QSharedPointer<WQmlCreatorDelegateData> data, QObject *parent, const QVariantMap &initialProperties);
+    void onIncubatorStatusChanged(QSharedPointer<WQmlCreatorDelegateData> data, QQmlIncubator::Status status);
+    bool recycle(QObject *object, const QStringList &properties);
+    QObject *reuse(QObject *parent, const QVariantMap &initialProperties);
+    void trimPool();
+
+    friend class WQmlCreatorIncubator;
 
     QQmlComponent *m_delegate = nullptr;
     QObject *m_parent = nullptr;
     QString m_chooserRole;
     QVariant m_chooserRoleValue;
     bool m_autoDestroy = true;
+    bool m_asynchronous = false;
+    int m_incubationBudget = 5;
+    int m_poolSize = 0;
+    struct PooledObject {
+        QPointer<QObject> object;
+        // The initial properties written by the previous data
+        QStringList properties;
+    };
+    QList<PooledObject> m_pool;
 
     QList<QSharedPointer<WQmlCreatorDelegateData>> m_datas;
 };
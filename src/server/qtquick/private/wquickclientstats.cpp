@@ -0,0 +1,58 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wquickclientstats_p.h"
+
+#include <QQmlInfo>
+#include <QMetaEnum>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+WQuickClientStats::WQuickClientStats(QObject *parent)
+    : WQuickWaylandServerInterface(parent)
+{
+
+}
+
+QList<WClientStatsEntry> WQuickClientStats::stats(const QString &sortBy, int limit) const
+{
+    if (!m_stats)
+        return {};
+
+    auto sortKey = WClientStats::HandlerTimePerSecond;
+    if (!sortBy.isEmpty()) {
+        QByteArray key = sortBy.toLatin1();
+        key[0] = QChar::toUpper(key.at(0));
+
+        bool ok = false;
+        int value = QMetaEnum::fromType<WClientStats::SortKey>().keyToValue(key.constData(), &ok);
+        if (ok)
+            sortKey = static_cast<WClientStats::SortKey>(value);
+        else
+            qmlWarning(this) << "Can't sort by" << sortBy;
+    }
+
+    return m_stats->stats(sortKey, limit);
+}
+
+WClientStatsEntry WQuickClientStats::clientStats(qint64 pid) const
+{
+    if (!m_stats)
+        return {};
+
+    const auto list = m_stats->stats(WClientStats::Pid);
+    for (const auto &entry : list) {
+        if (entry.pid == pid)
+            return entry;
+    }
+
+    return {};
+}
+
+void WQuickClientStats::create()
+{
+    WQuickWaylandServerInterface::create();
+    m_stats = server()->attach<WClientStats>();
+}
+
+WAYLIB_SERVER_END_NAMESPACE
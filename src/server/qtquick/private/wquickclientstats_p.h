@@ -0,0 +1,32 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+#include <wquickwaylandserver.h>
+#include <wclientstats.h>
+
+#include <QQmlEngine>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WAYLIB_SERVER_EXPORT WQuickClientStats : public WQuickWaylandServerInterface
+{
+    Q_OBJECT
+    QML_NAMED_ELEMENT(ClientStats)
+
+public:
+    explicit WQuickClientStats(QObject *parent = nullptr);
+
+    // The sortBy is the property name of clientStats, e.g. "commitsPerSecond"
+    Q_INVOKABLE QList<WAYLIB_SERVER_NAMESPACE::WClientStatsEntry> stats(const QString &sortBy = QString(), int limit = -1) const;
+    Q_INVOKABLE WAYLIB_SERVER_NAMESPACE::WClientStatsEntry clientStats(qint64 pid) const;
+
+private:
+    void create() override;
+
+    WClientStats *m_stats = nullptr;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
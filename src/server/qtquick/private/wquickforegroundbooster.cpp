@@ -0,0 +1,114 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wquickforegroundbooster_p.h"
+#include "wforegroundbooster.h"
+#include "wseat.h"
+
+#include <QQmlInfo>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+WQuickForegroundBooster::WQuickForegroundBooster(QObject *parent)
+    : WQuickWaylandServerInterface(parent)
+{
+
+}
+
+WSeat *WQuickForegroundBooster::seat() const
+{
+    return m_seat;
+}
+
+void WQuickForegroundBooster::setSeat(WSeat *newSeat)
+{
+    if (m_seat == newSeat)
+        return;
+
+    if (m_booster) {
+        qmlWarning(this) << "Can't change \"seat\" after the booster created";
+        return;
+    }
+
+    m_seat = newSeat;
+    Q_EMIT seatChanged();
+}
+
+int WQuickForegroundBooster::foregroundNice() const
+{
+    return m_foregroundNice;
+}
+
+void WQuickForegroundBooster::setForegroundNice(int newForegroundNice)
+{
+    if (m_foregroundNice == newForegroundNice)
+        return;
+    m_foregroundNice = newForegroundNice;
+    if (m_booster)
+        m_booster->setForegroundNice(m_foregroundNice);
+    Q_EMIT foregroundNiceChanged();
+}
+
+int WQuickForegroundBooster::backgroundNice() const
+{
+    return m_backgroundNice;
+}
+
+void WQuickForegroundBooster::setBackgroundNice(int newBackgroundNice)
+{
+    if (m_backgroundNice == newBackgroundNice)
+        return;
+    m_backgroundNice = newBackgroundNice;
+    if (m_booster)
+        m_booster->setBackgroundNice(m_backgroundNice);
+    Q_EMIT backgroundNiceChanged();
+}
+
+int WQuickForegroundBooster::foregroundWeight() const
+{
+    return m_foregroundWeight;
+}
+
+void WQuickForegroundBooster::setForegroundWeight(int newForegroundWeight)
+{
+    if (m_foregroundWeight == newForegroundWeight)
+        return;
+    m_foregroundWeight = newForegroundWeight;
+    if (m_booster)
+        m_booster->setForegroundWeight(m_foregroundWeight);
+    Q_EMIT foregroundWeightChanged();
+}
+
+int WQuickForegroundBooster::backgroundWeight() const
+{
+    return m_backgroundWeight;
+}
+
+void WQuickForegroundBooster::setBackgroundWeight(int newBackgroundWeight)
+{
+    if (m_backgroundWeight == newBackgroundWeight)
+        return;
+    m_backgroundWeight = newBackgroundWeight;
+    if (m_booster)
+        m_booster->setBackgroundWeight(m_backgroundWeight);
+    Q_EMIT backgroundWeightChanged();
+}
+
+void WQuickForegroundBooster::create()
+{
+    WQuickWaylandServerInterface::create();
+
+    if (!m_seat) {
+        qmlWarning(this) << "The \"seat\" is null, can't follow the keyboard focus";
+        return;
+    }
+
+    m_booster = new WForegroundBooster(m_seat);
+    m_booster->setForegroundNice(m_foregroundNice);
+    m_booster->setBackgroundNice(m_backgroundNice);
+    m_booster->setForegroundWeight(m_foregroundWeight);
+    m_booster->setBackgroundWeight(m_backgroundWeight);
+    server()->attach(m_booster);
+}
+
+WAYLIB_SERVER_END_NAMESPACE
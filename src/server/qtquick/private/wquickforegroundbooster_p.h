@@ -0,0 +1,63 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+#include <wquickwaylandserver.h>
+
+#include <QQmlEngine>
+
+Q_MOC_INCLUDE(<wseat.h>)
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WSeat;
+class WForegroundBooster;
+class WAYLIB_SERVER_EXPORT WQuickForegroundBooster : public WQuickWaylandServerInterface
+{
+    Q_OBJECT
+    Q_PROPERTY(WSeat* seat READ seat WRITE setSeat NOTIFY seatChanged FINAL REQUIRED)
+    Q_PROPERTY(int foregroundNice READ foregroundNice WRITE setForegroundNice NOTIFY foregroundNiceChanged FINAL)
+    Q_PROPERTY(int backgroundNice READ backgroundNice WRITE setBackgroundNice NOTIFY backgroundNiceChanged FINAL)
+    Q_PROPERTY(int foregroundWeight READ foregroundWeight WRITE setForegroundWeight NOTIFY foregroundWeightChanged FINAL)
+    Q_PROPERTY(int backgroundWeight READ backgroundWeight WRITE setBackgroundWeight NOTIFY backgroundWeightChanged FINAL)
+    QML_NAMED_ELEMENT(ForegroundBooster)
+
+public:
+    explicit WQuickForegroundBooster(QObject *parent = nullptr);
+
+    WSeat *seat() const;
+    void setSeat(WSeat *newSeat);
+
+    int foregroundNice() const;
+    void setForegroundNice(int newForegroundNice);
+
+    int backgroundNice() const;
+    void setBackgroundNice(int newBackgroundNice);
+
+    int foregroundWeight() const;
+    void setForegroundWeight(int newForegroundWeight);
+
+    int backgroundWeight() const;
+    void setBackgroundWeight(int newBackgroundWeight);
+
+Q_SIGNALS:
+    void seatChanged();
+    void foregroundNiceChanged();
+    void backgroundNiceChanged();
+    void foregroundWeightChanged();
+    void backgroundWeightChanged();
+
+private:
+    void create() override;
+
+    WSeat *m_seat = nullptr;
+    WForegroundBooster *m_booster = nullptr;
+    int m_foregroundNice = -5;
+    int m_backgroundNice = 2;
+    int m_foregroundWeight = 200;
+    int m_backgroundWeight = 50;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
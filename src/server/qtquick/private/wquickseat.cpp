@@ -10,6 +10,9 @@
 #include <qwoutput.h>
 
 #include <QRect>
+#include <QQmlInfo>
+
+#include <xkbcommon/xkbcommon.h>
 
 extern "C" {
 #define static
@@ -38,12 +41,15 @@ public:
     }
 
     void updateCursorMap();
+    void updatePassthroughShortcuts();
 
     W_DECLARE_PUBLIC(WQuickSeat)
 
     WSeat *seat = nullptr;
     WSeatEventFilter *eventFilter = nullptr;
     WSurface *keyboardFocus = nullptr;
+    bool inputPassthrough = false;
+    QStringList passthroughShortcuts;
     QString name;
     QList<WOutput*> outputs;
     WQuickCursor *cursor = nullptr;
@@ -83,6 +89,50 @@ void WQuickSeatPrivate::updateCursorMap()
     }
 }
 
+void WQuickSeatPrivate::updatePassthroughShortcuts()
+{
+    W_Q(WQuickSeat);
+    QList<WSeat::KeysymShortcut> list;
+    list.reserve(passthroughShortcuts.size());
+
+    for (const auto &shortcut : std::as_const(passthroughShortcuts)) {
+        const auto keys = shortcut.split(QLatin1Char('+'), Qt::SkipEmptyParts);
+        if (keys.isEmpty())
+            continue;
+
+        Qt::KeyboardModifiers modifiers;
+        bool ok = true;
+        for (int i = 0; i < keys.size() - 1; ++i) {
+            const auto &key = keys.at(i).trimmed();
+            if (key.compare(QLatin1String("Ctrl"), Qt::CaseInsensitive) == 0
+                || key.compare(QLatin1String("Control"), Qt::CaseInsensitive) == 0) {
+                modifiers |= Qt::ControlModifier;
+            } else if (key.compare(QLatin1String("Alt"), Qt::CaseInsensitive) == 0) {
+                modifiers |= Qt::AltModifier;
+            } else if (key.compare(QLatin1String("Shift"), Qt::CaseInsensitive) == 0) {
+                modifiers |= Qt::ShiftModifier;
+            } else if (key.compare(QLatin1String("Meta"), Qt::CaseInsensitive) == 0
+                       || key.compare(QLatin1String("Super"), Qt::CaseInsensitive) == 0) {
+                modifiers |= Qt::MetaModifier;
+            } else {
+                ok = false;
+                break;
+            }
+        }
+
+        const xkb_keysym_t sym = xkb_keysym_from_name(keys.last().trimmed().toLatin1().constData(),
+                                                      XKB_KEYSYM_CASE_INSENSITIVE);
+        if (!ok || sym == XKB_KEY_NoSymbol) {
+            qmlWarning(q) << "Invalid passthrough shortcut:" << shortcut;
+            continue;
+        }
+
+        list.append({sym, modifiers});
+    }
+
+    seat->setPassthroughShortcuts(list);
+}
+
 WQuickSeat::WQuickSeat(QObject *parent)
     : WQuickWaylandServerInterface(parent)
     , WObject(*new WQuickSeatPrivate(this))
@@ -167,6 +217,42 @@ void WQuickSeat::setKeyboardFocus(WSurface *newKeyboardFocus)
     Q_EMIT keyboardFocusChanged();
 }
 
+bool WQuickSeat::inputPassthrough() const
+{
+    W_DC(WQuickSeat);
+    return d->inputPassthrough;
+}
+
+void WQuickSeat::setInputPassthrough(bool newInputPassthrough)
+{
+    W_D(WQuickSeat);
+    if (d->inputPassthrough == newInputPassthrough)
+        return;
+    d->inputPassthrough = newInputPassthrough;
+    if (d->seat)
+        d->seat->setInputPassthrough(newInputPassthrough);
+
+    Q_EMIT inputPassthroughChanged();
+}
+
+QStringList WQuickSeat::passthroughShortcuts() const
+{
+    W_DC(WQuickSeat);
+    return d->passthroughShortcuts;
+}
+
+void WQuickSeat::setPassthroughShortcuts(const QStringList &newPassthroughShortcuts)
+{
+    W_D(WQuickSeat);
+    if (d->passthroughShortcuts == newPassthroughShortcuts)
+        return;
+    d->passthroughShortcuts = newPassthroughShortcuts;
+    if (d->seat)
+        d->updatePassthroughShortcuts();
+
+    Q_EMIT passthroughShortcutsChanged();
+}
+
 void WQuickSeat::addDevice(WInputDevice *device)
 {
     W_D(WQuickSeat);
@@ -212,6 +298,9 @@ void WQuickSeat::create()
         d->seat->setEventFilter(d->eventFilter);
     if (d->keyboardFocus)
         d->seat->setKeyboardFocusTarget(d->keyboardFocus);
+    if (!d->passthroughShortcuts.isEmpty())
+        d->updatePassthroughShortcuts();
+    d->seat->setInputPassthrough(d->inputPassthrough);
 
     Q_EMIT seatChanged();
 }
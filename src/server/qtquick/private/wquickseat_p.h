@@ -27,6 +27,9 @@ class WAYLIB_SERVER_EXPORT WQuickSeat : public WQuickWaylandServerInterface, pub
     Q_PROPERTY(WQuickCursor* cursor READ cursor WRITE setCursor NOTIFY cursorChanged)
     Q_PROPERTY(WSeatEventFilter* eventFilter READ eventFilter WRITE setEventFilter NOTIFY eventFilterChanged)
     Q_PROPERTY(WSurface* keyboardFocus READ keyboardFocus WRITE setKeyboardFocus NOTIFY keyboardFocusChanged FINAL)
+    Q_PROPERTY(bool inputPassthrough READ inputPassthrough WRITE setInputPassthrough NOTIFY inputPassthroughChanged FINAL)
+    // Such as "Meta+Tab", "Ctrl+Alt+F1", the key is a xkb keysym name
+    Q_PROPERTY(QStringList passthroughShortcuts READ passthroughShortcuts WRITE setPassthroughShortcuts NOTIFY passthroughShortcutsChanged FINAL)
 
 public:
     explicit WQuickSeat(QObject *parent = nullptr);
@@ -45,6 +48,12 @@ public:
     WSurface *keyboardFocus() const;
     void setKeyboardFocus(WSurface *newKeyboardFocus);
 
+    bool inputPassthrough() const;
+    void setInputPassthrough(bool newInputPassthrough);
+
+    QStringList passthroughShortcuts() const;
+    void setPassthroughShortcuts(const QStringList &newPassthroughShortcuts);
+
 public Q_SLOTS:
     void addDevice(WInputDevice *device);
     void removeDevice(WInputDevice *device);
@@ -54,6 +63,8 @@ Q_SIGNALS:
     void cursorChanged();
     void eventFilterChanged();
     void keyboardFocusChanged();
+    void inputPassthroughChanged();
+    void passthroughShortcutsChanged();
 
 private:
     friend class WOutputViewport;
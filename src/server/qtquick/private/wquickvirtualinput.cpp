@@ -0,0 +1,48 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wquickvirtualinput_p.h"
+#include "wvirtualinput.h"
+#include "wseat.h"
+
+#include <QQmlInfo>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+WQuickVirtualInputManager::WQuickVirtualInputManager(QObject *parent)
+    : WQuickWaylandServerInterface(parent)
+{
+
+}
+
+WSeat *WQuickVirtualInputManager::seat() const
+{
+    return m_seat;
+}
+
+void WQuickVirtualInputManager::setSeat(WSeat *newSeat)
+{
+    if (m_seat == newSeat)
+        return;
+
+    if (m_pointerManager) {
+        qmlWarning(this) << "Can't change \"seat\" after the virtual input managers created";
+        return;
+    }
+
+    m_seat = newSeat;
+    Q_EMIT seatChanged();
+}
+
+void WQuickVirtualInputManager::create()
+{
+    WQuickWaylandServerInterface::create();
+
+    if (!m_seat)
+        qmlWarning(this) << "The \"seat\" is null, the virtual devices will not attach to any seat";
+
+    m_pointerManager = server()->attach<WVirtualPointerManager>(m_seat);
+    m_keyboardManager = server()->attach<WVirtualKeyboardManager>(m_seat);
+}
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -0,0 +1,41 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+#include <wquickwaylandserver.h>
+
+#include <QQmlEngine>
+
+Q_MOC_INCLUDE(<wseat.h>)
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WSeat;
+class WVirtualPointerManager;
+class WVirtualKeyboardManager;
+class WAYLIB_SERVER_EXPORT WQuickVirtualInputManager : public WQuickWaylandServerInterface
+{
+    Q_OBJECT
+    Q_PROPERTY(WSeat* seat READ seat WRITE setSeat NOTIFY seatChanged FINAL REQUIRED)
+    QML_NAMED_ELEMENT(VirtualInputManager)
+
+public:
+    explicit WQuickVirtualInputManager(QObject *parent = nullptr);
+
+    WSeat *seat() const;
+    void setSeat(WSeat *newSeat);
+
+Q_SIGNALS:
+    void seatChanged();
+
+private:
+    void create() override;
+
+    WSeat *m_seat = nullptr;
+    WVirtualPointerManager *m_pointerManager = nullptr;
+    WVirtualKeyboardManager *m_keyboardManager = nullptr;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -0,0 +1,146 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wxcursorthemecache_p.h"
+
+#include <qwxcursormanager.h>
+
+#include <QThreadPool>
+
+extern "C" {
+#include <wlr/types/wlr_xcursor_manager.h>
+#include <wlr/xcursor.h>
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+using CursorFrames = QHash<QByteArray, WXCursorThemeCache::Frames>;
+
+// Same as wlr_xcursor_manager_load, runs in a thread of the pool
+static CursorFrames decodeTheme(const QByteArray &name, quint32 size, float scale)
+{
+    CursorFrames cursors;
+    auto theme = wlr_xcursor_theme_load(name.isEmpty() ? nullptr : name.constData(), int(size * scale));
+    if (!theme)
+        return cursors;
+
+    for (unsigned i = 0; i < theme->cursor_count; ++i) {
+        auto xcursor = theme->cursors[i];
+        WXCursorThemeCache::Frames frames;
+        frames.reserve(xcursor->image_count);
+
+        for (unsigned j = 0; j < xcursor->image_count; ++j) {
+            auto image = xcursor->images[j];
+            // The xcursor pixels are premultiplied ARGB, owned by the theme
+            const QImage qimage(image->buffer, image->width, image->height,
+                                image->width * 4, QImage::Format_ARGB32_Premultiplied);
+            frames.append({qimage.copy(), QPoint(image->hotspot_x, image->hotspot_y), int(image->delay)});
+        }
+
+        cursors.insert(QByteArray(xcursor->name), frames);
+    }
+
+    wlr_xcursor_theme_destroy(theme);
+    return cursors;
+}
+
+WXCursorThemeCache::WXCursorThemeCache()
+{
+
+}
+
+WXCursorThemeCache *WXCursorThemeCache::instance()
+{
+    static WXCursorThemeCache *cache = new WXCursorThemeCache();
+    return cache;
+}
+
+QWXCursorManager *WXCursorThemeCache::acquire(const QByteArray &theme, quint32 size)
+{
+    for (auto t : std::as_const(m_themes)) {
+        if (t->name == theme && t->size == size) {
+            ++t->refCount;
+            return t->manager;
+        }
+    }
+
+    auto manager = QWXCursorManager::create(theme.isEmpty() ? nullptr : theme.constData(), size);
+    if (!manager)
+        return nullptr;
+
+    auto t = new Theme;
+    t->serial = ++m_nextSerial;
+    t->name = theme;
+    t->size = size;
+    t->manager = manager;
+    t->refCount = 1;
+    m_themes.append(t);
+
+    return manager;
+}
+
+void WXCursorThemeCache::release(QWXCursorManager *manager)
+{
+    auto theme = themeOf(manager);
+    if (!theme)
+        return;
+
+    if (--theme->refCount > 0)
+        return;
+
+    m_themes.removeOne(theme);
+    delete theme->manager;
+    delete theme;
+}
+
+void WXCursorThemeCache::preload(QWXCursorManager *manager, float scale)
+{
+    auto theme = themeOf(manager);
+    if (!theme || theme->scales.contains(scale))
+        return;
+
+    theme->scales.insert(scale, {});
+
+    const quint64 serial = theme->serial;
+    const QByteArray name = theme->name;
+    const quint32 size = theme->size;
+
+    // The cache is never destroyed
+    QThreadPool::globalInstance()->start([this, serial, name, size, scale] {
+        CursorFrames cursors = decodeTheme(name, size, scale);
+
+        QMetaObject::invokeMethod(this, [this, serial, scale, cursors = std::move(cursors)] {
+            for (auto t : std::as_const(m_themes)) {
+                // The theme maybe is released in decoding
+                if (t->serial != serial)
+                    continue;
+
+                t->scales[scale] = cursors;
+                Q_EMIT themeLoaded(t->manager, scale);
+                break;
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+WXCursorThemeCache::Frames WXCursorThemeCache::frames(QWXCursorManager *manager, const QByteArray &name, float scale) const
+{
+    auto theme = themeOf(manager);
+    if (!theme)
+        return {};
+
+    return theme->scales.value(scale).value(name);
+}
+
+WXCursorThemeCache::Theme *WXCursorThemeCache::themeOf(QWXCursorManager *manager) const
+{
+    for (auto theme : m_themes) {
+        if (theme->manager == manager)
+            return theme;
+    }
+
+    return nullptr;
+}
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -0,0 +1,70 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+#include <qwglobal.h>
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+
+QW_BEGIN_NAMESPACE
+class QWXCursorManager;
+QW_END_NAMESPACE
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// The xcursor managers are shared by all the cursors with the same theme and
+// size, so a theme is loaded once per scale. The images of a theme are also
+// decoded in the thread pool for each scale in use, they are used by the
+// scene graph cursors, including the frames of the animated cursors.
+class WXCursorThemeCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Frame {
+        QImage image;
+        QPoint hotspot;
+        // msecs
+        int delay = 0;
+    };
+    using Frames = QList<Frame>;
+
+    static WXCursorThemeCache *instance();
+
+    // The theme is null for the default theme
+    QW_NAMESPACE::QWXCursorManager *acquire(const QByteArray &theme, quint32 size);
+    void release(QW_NAMESPACE::QWXCursorManager *manager);
+
+    // Decode the images of the theme at the scale in background if they are not
+    void preload(QW_NAMESPACE::QWXCursorManager *manager, float scale);
+    // Empty if it's not decoded yet or not exists
+    Frames frames(QW_NAMESPACE::QWXCursorManager *manager, const QByteArray &name, float scale) const;
+
+Q_SIGNALS:
+    void themeLoaded(QW_NAMESPACE::QWXCursorManager *manager, float scale);
+
+private:
+    explicit WXCursorThemeCache();
+
+    struct Theme {
+        quint64 serial = 0;
+        QByteArray name;
+        quint32 size = 0;
+        QW_NAMESPACE::QWXCursorManager *manager = nullptr;
+        int refCount = 0;
+        // scale -> cursor name -> frames, the scale is in the map before decoded
+        QHash<float, QHash<QByteArray, Frames>> scales;
+    };
+
+    Theme *themeOf(QW_NAMESPACE::QWXCursorManager *manager) const;
+
+    QList<Theme*> m_themes;
+    quint64 m_nextSerial = 0;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
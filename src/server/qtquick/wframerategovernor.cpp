@@ -0,0 +1,378 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wframerategovernor.h"
+#include "wsurface.h"
+#include "wseat.h"
+#include "wxdgsurface.h"
+
+#include <qwcompositor.h>
+#include <qwxdgshell.h>
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QQmlInfo>
+
+extern "C" {
+#include <wayland-server-core.h>
+#define static
+#include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_xdg_shell.h>
+#undef static
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// A frame earlier than the interval within this is not delayed, the
+// frames of output are not exactly aligned to the interval of the cap.
+static constexpr qint64 FrameTolerance = 3;
+
+static WFrameRateGovernor *currentGovernor = nullptr;
+
+struct ClientFrameState
+{
+    wl_listener destroy;
+    WFrameRateGovernorPrivate *governor;
+    wl_client *client;
+    // Only the xdg toplevel has app id, X11 clients are all the Xwayland client
+    QString appId;
+
+    qint64 lastFrame = -1;
+    qint64 windowStart = 0;
+    int windowFrames = 0;
+    qreal frameRate = 0;
+};
+
+class WFrameRateGovernorPrivate : public WObjectPrivate
+{
+public:
+    WFrameRateGovernorPrivate(WFrameRateGovernor *qq)
+        : WObjectPrivate(qq)
+    {
+        clock.start();
+    }
+
+    ClientFrameState *ensureClient(wl_client *client);
+    void removeClient(ClientFrameState *state);
+    int capFor(ClientFrameState *state) const;
+    void rollWindow(ClientFrameState *state, qint64 now) const;
+    void deliver(WSurface *surface, ClientFrameState *state, qint64 now, qint64 renderTime = 0);
+    void defer(WSurface *surface, qint64 deadline);
+    void onDeferTimeout();
+
+    static void handle_client_destroy(wl_listener *listener, void *);
+
+    W_DECLARE_PUBLIC(WFrameRateGovernor)
+
+    WSeat *seat = nullptr;
+    int unfocusedFrameRate = 0;
+    QVariantMap appIdFrameRates;
+    QHash<QString, int> appIdCaps;
+
+    QElapsedTimer clock;
+    QHash<wl_client*, ClientFrameState*> clients;
+    QHash<WSurface*, qint64> lastDelivered;
+    QHash<WSurface*, qint64> deferred;
+    QTimer *deferTimer = nullptr;
+};
+
+static inline wl_client *clientOf(WSurface *surface)
+{
+    return wl_resource_get_client(surface->handle()->handle()->resource);
+}
+
+ClientFrameState *WFrameRateGovernorPrivate::ensureClient(wl_client *client)
+{
+    if (auto state = clients.value(client))
+        return state;
+
+    auto state = new ClientFrameState;
+    state->governor = this;
+    state->client = client;
+    state->windowStart = clock.elapsed();
+    state->destroy.notify = handle_client_destroy;
+    wl_client_add_destroy_listener(client, &state->destroy);
+    clients.insert(client, state);
+
+    return state;
+}
+
+void WFrameRateGovernorPrivate::removeClient(ClientFrameState *state)
+{
+    clients.remove(state->client);
+    wl_list_remove(&state->destroy.link);
+    delete state;
+}
+
+int WFrameRateGovernorPrivate::capFor(ClientFrameState *state) const
+{
+    if (!state->appId.isEmpty()) {
+        auto it = appIdCaps.constFind(state->appId);
+        if (it != appIdCaps.constEnd())
+            return *it;
+    }
+
+    if (unfocusedFrameRate <= 0 || !seat)
+        return 0;
+
+    auto focus = seat->keyboardFocusSurface();
+    if (focus && clientOf(focus) == state->client)
+        return 0;
+
+    return unfocusedFrameRate;
+}
+
+void WFrameRateGovernorPrivate::rollWindow(ClientFrameState *state, qint64 now) const
+{
+    const qint64 elapsed = now - state->windowStart;
+    if (elapsed < 1000)
+        return;
+
+    state->frameRate = state->windowFrames * 1000.0 / elapsed;
+    state->windowFrames = 0;
+    state->windowStart = now;
+}
+
+void WFrameRateGovernorPrivate::deliver(WSurface *surface, ClientFrameState *state, qint64 now, qint64 renderTime)
+{
+    lastDelivered[surface] = now;
+    deferred.remove(surface);
+
+    // The surfaces of a client are usually in the same frame
+    if (state->lastFrame != now) {
+        state->lastFrame = now;
+        rollWindow(state, now);
+        ++state->windowFrames;
+    }
+
+    surface->scheduleFrameDone(renderTime);
+}
+
+void WFrameRateGovernorPrivate::defer(WSurface *surface, qint64 deadline)
+{
+    if (deferred.contains(surface))
+        return;
+
+    deferred.insert(surface, deadline);
+    const qint64 remaining = qMax<qint64>(0, deadline - clock.elapsed());
+    if (!deferTimer->isActive() || deferTimer->remainingTime() > remaining)
+        deferTimer->start(remaining);
+}
+
+void WFrameRateGovernorPrivate::onDeferTimeout()
+{
+    const qint64 now = clock.elapsed();
+    qint64 next = -1;
+
+    const auto list = deferred;
+    for (auto it = list.constBegin(); it != list.constEnd(); ++it) {
+        if (it.value() - FrameTolerance <= now) {
+            deliver(it.key(), ensureClient(clientOf(it.key())), now);
+        } else if (next < 0 || it.value() < next) {
+            next = it.value();
+        }
+    }
+
+    if (next >= 0)
+        deferTimer->start(qMax<qint64>(0, next - now));
+}
+
+void WFrameRateGovernorPrivate::handle_client_destroy(wl_listener *listener, void *)
+{
+    ClientFrameState *state = wl_container_of(listener, state, destroy);
+    state->governor->removeClient(state);
+}
+
+WFrameRateGovernor::WFrameRateGovernor(QObject *parent)
+    : QObject(parent)
+    , WObject(*new WFrameRateGovernorPrivate(this))
+{
+    W_D(WFrameRateGovernor);
+
+    d->deferTimer = new QTimer(this);
+    d->deferTimer->setSingleShot(true);
+    d->deferTimer->setTimerType(Qt::PreciseTimer);
+    connect(d->deferTimer, &QTimer::timeout, this, [d] {
+        d->onDeferTimeout();
+    });
+
+    if (currentGovernor)
+        qmlWarning(this) << "Only one FrameRateGovernor works at a time, this is ignored";
+    else
+        currentGovernor = this;
+}
+
+WFrameRateGovernor::~WFrameRateGovernor()
+{
+    W_D(WFrameRateGovernor);
+
+    if (currentGovernor == this)
+        currentGovernor = nullptr;
+
+    // Don't keep the frame callbacks of client waiting
+    const auto list = d->deferred.keys();
+    for (auto surface : list)
+        surface->notifyFrameDone();
+
+    const auto clients = d->clients.values();
+    for (auto state : clients)
+        d->removeClient(state);
+}
+
+WFrameRateGovernor *WFrameRateGovernor::instance()
+{
+    return currentGovernor;
+}
+
+WSeat *WFrameRateGovernor::seat() const
+{
+    W_DC(WFrameRateGovernor);
+    return d->seat;
+}
+
+void WFrameRateGovernor::setSeat(WSeat *newSeat)
+{
+    W_D(WFrameRateGovernor);
+    if (d->seat == newSeat)
+        return;
+    d->seat = newSeat;
+    Q_EMIT seatChanged();
+}
+
+int WFrameRateGovernor::unfocusedFrameRate() const
+{
+    W_DC(WFrameRateGovernor);
+    return d->unfocusedFrameRate;
+}
+
+void WFrameRateGovernor::setUnfocusedFrameRate(int newFrameRate)
+{
+    W_D(WFrameRateGovernor);
+    if (d->unfocusedFrameRate == newFrameRate)
+        return;
+    d->unfocusedFrameRate = newFrameRate;
+    Q_EMIT unfocusedFrameRateChanged();
+}
+
+QVariantMap WFrameRateGovernor::appIdFrameRates() const
+{
+    W_DC(WFrameRateGovernor);
+    return d->appIdFrameRates;
+}
+
+void WFrameRateGovernor::setAppIdFrameRates(const QVariantMap &newFrameRates)
+{
+    W_D(WFrameRateGovernor);
+    if (d->appIdFrameRates == newFrameRates)
+        return;
+
+    d->appIdFrameRates = newFrameRates;
+    d->appIdCaps.clear();
+    for (auto it = newFrameRates.constBegin(); it != newFrameRates.constEnd(); ++it) {
+        bool ok = false;
+        int rate = it.value().toInt(&ok);
+        if (!ok || rate < 0) {
+            qmlWarning(this) << "Invalid frame rate" << it.value() << "for" << it.key();
+            continue;
+        }
+        d->appIdCaps.insert(it.key(), rate);
+    }
+
+    Q_EMIT appIdFrameRatesChanged();
+}
+
+int WFrameRateGovernor::frameRateCap(WSurface *surface) const
+{
+    W_DC(WFrameRateGovernor);
+    if (!surface)
+        return 0;
+
+    auto state = d->clients.value(clientOf(surface));
+    if (!state) {
+        ClientFrameState tmp;
+        tmp.client = clientOf(surface);
+        return d->capFor(&tmp);
+    }
+
+    return d->capFor(state);
+}
+
+qreal WFrameRateGovernor::frameRate(WSurface *surface) const
+{
+    W_DC(WFrameRateGovernor);
+    if (!surface)
+        return 0;
+
+    auto state = d->clients.value(clientOf(surface));
+    if (!state)
+        return 0;
+
+    d->rollWindow(state, d->clock.elapsed());
+    return state->frameRate;
+}
+
+QVariantList WFrameRateGovernor::frameRates() const
+{
+    W_DC(WFrameRateGovernor);
+
+    QVariantList list;
+    const qint64 now = d->clock.elapsed();
+    for (auto state : std::as_const(d->clients)) {
+        d->rollWindow(state, now);
+
+        pid_t pid = 0;
+        wl_client_get_credentials(state->client, &pid, nullptr, nullptr);
+
+        list.append(QVariantMap {
+            {QStringLiteral("pid"), pid},
+            {QStringLiteral("appId"), state->appId},
+            {QStringLiteral("frameRate"), state->frameRate},
+            {QStringLiteral("frameRateCap"), d->capFor(state)},
+        });
+    }
+
+    return list;
+}
+
+void WFrameRateGovernor::notifyFrameDone(WSurface *surface, qint64 renderTime)
+{
+    W_D(WFrameRateGovernor);
+
+    auto nativeSurface = surface->handle()->handle();
+    // Nothing to send, and don't count it to the frame rate
+    if (wl_list_empty(&nativeSurface->current.frame_callback_list))
+        return;
+
+    auto state = d->ensureClient(clientOf(surface));
+    if (state->appId.isEmpty()) {
+        if (auto xdgSurface = WXdgSurface::fromSurface(surface)) {
+            if (auto toplevel = xdgSurface->handle()->topToplevel())
+                state->appId = QString::fromUtf8(toplevel->handle()->app_id);
+        }
+    }
+
+    const qint64 now = d->clock.elapsed();
+    const int cap = d->capFor(state);
+    if (cap > 0) {
+        const qint64 last = d->lastDelivered.value(surface, -1);
+        const qint64 interval = 1000 / cap;
+        if (last >= 0 && now - last < interval - FrameTolerance) {
+            // Maybe the output will not render any more, so send them by timer
+            d->defer(surface, last + interval);
+            return;
+        }
+    }
+
+    if (!d->lastDelivered.contains(surface)) {
+        // The WSurface is deleted later, don't touch its wlr_surface after destroyed
+        connect(surface->handle(), &QWSurface::beforeDestroy, this, [d, surface] {
+            d->lastDelivered.remove(surface);
+            d->deferred.remove(surface);
+        });
+    }
+
+    d->deliver(surface, state, now, renderTime);
+}
+
+WAYLIB_SERVER_END_NAMESPACE
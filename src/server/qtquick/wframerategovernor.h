@@ -0,0 +1,64 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <QObject>
+#include <QQmlEngine>
+
+Q_MOC_INCLUDE(<wseat.h>)
+Q_MOC_INCLUDE(<wsurface.h>)
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WSeat;
+class WSurface;
+class WFrameRateGovernorPrivate;
+// Decide whether the frame callbacks of a surface are sent on the frameDone
+// of WOutputViewport. The app id caps are preferred, 0 is not capped (the
+// output's refresh rate), otherwise the clients which has not the keyboard
+// focus are capped by unfocusedFrameRate. Only one governor works at a time.
+class WAYLIB_SERVER_EXPORT WFrameRateGovernor : public QObject, public WObject
+{
+    Q_OBJECT
+    W_DECLARE_PRIVATE(WFrameRateGovernor)
+    Q_PROPERTY(WSeat* seat READ seat WRITE setSeat NOTIFY seatChanged FINAL)
+    Q_PROPERTY(int unfocusedFrameRate READ unfocusedFrameRate WRITE setUnfocusedFrameRate NOTIFY unfocusedFrameRateChanged FINAL)
+    Q_PROPERTY(QVariantMap appIdFrameRates READ appIdFrameRates WRITE setAppIdFrameRates NOTIFY appIdFrameRatesChanged FINAL)
+    QML_NAMED_ELEMENT(FrameRateGovernor)
+
+public:
+    explicit WFrameRateGovernor(QObject *parent = nullptr);
+    ~WFrameRateGovernor();
+
+    static WFrameRateGovernor *instance();
+
+    WSeat *seat() const;
+    void setSeat(WSeat *newSeat);
+
+    int unfocusedFrameRate() const;
+    void setUnfocusedFrameRate(int newFrameRate);
+
+    QVariantMap appIdFrameRates() const;
+    void setAppIdFrameRates(const QVariantMap &newFrameRates);
+
+    // 0 is not capped
+    Q_INVOKABLE int frameRateCap(WAYLIB_SERVER_NAMESPACE::WSurface *surface) const;
+    // The frame callbacks per second which are sent to the client of surface
+    Q_INVOKABLE qreal frameRate(WAYLIB_SERVER_NAMESPACE::WSurface *surface) const;
+    // [{pid, appId, frameRate, frameRateCap}] of all clients which got frame callbacks
+    Q_INVOKABLE QVariantList frameRates() const;
+
+    // Send the frame callbacks now or later according to the cap,
+    // the renderTime is passed to WSurface::scheduleFrameDone.
+    void notifyFrameDone(WSurface *surface, qint64 renderTime = 0);
+
+Q_SIGNALS:
+    void seatChanged();
+    void unfocusedFrameRateChanged();
+    void appIdFrameRatesChanged();
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -3,8 +3,11 @@
 
 #include "woutputlayoutitem.h"
 #include "woutput.h"
+#include "wsurface.h"
 #include "wquickoutputlayout.h"
 
+#include <QPointer>
+
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
@@ -17,6 +20,13 @@ public:
 
     }
 
+    // The geometry maybe changed many times in a frame, only
+    // compute the intersected outputs at the polish of next frame
+    void scheduleUpdateOutputs() {
+        W_Q(WOutputLayoutItem);
+        q->polish();
+    }
+
     void updateOutputs() {
         if (!layout)
             return;
@@ -39,21 +49,33 @@ public:
             changed = true;
         }
 
-        if (changed)
-            Q_EMIT q->outputsChanged();
+        if (!changed)
+            return;
+
+        if (surface)
+            surface->setOutputs(outputs);
+        Q_EMIT q->outputsChanged();
     }
 
     W_DECLARE_PUBLIC(WOutputLayoutItem)
     QList<WOutput*> outputs;
     WQuickOutputLayout *layout = nullptr;
+    QPointer<WSurface> surface;
 };
 
 WOutputLayoutItem::WOutputLayoutItem(QQuickItem *parent)
     : WQuickObserver(parent)
     , WObject(*new WOutputLayoutItemPrivate(this))
 {
-    connect(this, SIGNAL(transformChanged(QQuickItem*)), this, SLOT(updateOutputs()));
-    connect(this, SIGNAL(maybeGlobalPositionChanged()), this, SLOT(updateOutputs()));
+    connect(this, SIGNAL(transformChanged(QQuickItem*)), this, SLOT(scheduleUpdateOutputs()));
+    connect(this, SIGNAL(maybeGlobalPositionChanged()), this, SLOT(scheduleUpdateOutputs()));
+}
+
+WOutputLayoutItem::~WOutputLayoutItem()
+{
+    W_D(WOutputLayoutItem);
+    if (d->surface)
+        d->surface->setOutputs({});
 }
 
 WQuickOutputLayout *WOutputLayoutItem::layout() const
@@ -74,7 +96,7 @@ void WOutputLayoutItem::setLayout(WQuickOutputLayout *newLayout)
     d->layout = newLayout;
 
     if (d->layout)
-        connect(d->layout, SIGNAL(maybeLayoutChanged()), this, SLOT(updateOutputs()));
+        connect(d->layout, SIGNAL(maybeLayoutChanged()), this, SLOT(scheduleUpdateOutputs()));
 
     if (isComponentComplete())
         d->updateOutputs();
@@ -87,6 +109,27 @@ void WOutputLayoutItem::resetOutput()
     setLayout(nullptr);
 }
 
+WSurface *WOutputLayoutItem::surface() const
+{
+    W_DC(WOutputLayoutItem);
+    return d->surface;
+}
+
+void WOutputLayoutItem::setSurface(WSurface *newSurface)
+{
+    W_D(WOutputLayoutItem);
+    if (d->surface == newSurface)
+        return;
+
+    if (d->surface)
+        d->surface->setOutputs({});
+    d->surface = newSurface;
+    if (d->surface)
+        d->surface->setOutputs(d->outputs);
+
+    Q_EMIT surfaceChanged();
+}
+
 QList<WOutput*> WOutputLayoutItem::outputs() const
 {
     W_DC(WOutputLayoutItem);
@@ -100,6 +143,13 @@ void WOutputLayoutItem::componentComplete()
     d_func()->updateOutputs();
 }
 
+void WOutputLayoutItem::updatePolish()
+{
+    WQuickObserver::updatePolish();
+
+    d_func()->updateOutputs();
+}
+
 WAYLIB_SERVER_END_NAMESPACE
 
 #include "moc_woutputlayoutitem.cpp"
@@ -9,6 +9,7 @@
 #include <QQuickItem>
 
 Q_MOC_INCLUDE("woutput.h")
+Q_MOC_INCLUDE("wsurface.h")
 Q_MOC_INCLUDE(<wquickoutputlayout.h>)
 
 QW_BEGIN_NAMESPACE
@@ -18,6 +19,7 @@ QW_END_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
 class WOutput;
+class WSurface;
 class WQuickOutputLayout;
 class WOutputLayoutItemPrivate;
 class WAYLIB_SERVER_EXPORT WOutputLayoutItem : public WQuickObserver, public WObject
@@ -27,9 +29,11 @@ class WAYLIB_SERVER_EXPORT WOutputLayoutItem : public WQuickObserver, public WOb
     QML_NAMED_ELEMENT(OutputLayoutItem)
     Q_PROPERTY(WQuickOutputLayout* layout READ layout WRITE setLayout NOTIFY layoutChanged)
     Q_PROPERTY(QList<WOutput*> outputs READ outputs RESET resetOutput NOTIFY outputsChanged)
+    Q_PROPERTY(WSurface* surface READ surface WRITE setSurface NOTIFY surfaceChanged FINAL)
 
 public:
     explicit WOutputLayoutItem(QQuickItem *parent = nullptr);
+    ~WOutputLayoutItem() override;
 
     QList<WOutput*> outputs() const;
 
@@ -37,17 +41,24 @@ public:
     void setLayout(WQuickOutputLayout *newLayout);
     void resetOutput();
 
+    // The surface enters and leaves the outputs of this item, it's updated
+    // at most once per frame
+    WSurface *surface() const;
+    void setSurface(WSurface *newSurface);
+
 Q_SIGNALS:
     void outputsChanged();
     void enterOutput(WOutput *output);
     void leaveOutput(WOutput *output);
 
     void layoutChanged();
+    void surfaceChanged();
 
 private:
     void componentComplete() override;
+    void updatePolish() override;
 
-    W_PRIVATE_SLOT(void updateOutputs())
+    W_PRIVATE_SLOT(void scheduleUpdateOutputs())
 };
 
 WAYLIB_SERVER_END_NAMESPACE
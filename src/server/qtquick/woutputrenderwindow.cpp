@@ -7,6 +7,7 @@
 #include "wserver.h"
 #include "wbackend.h"
 #include "woutputviewport.h"
+#include "woutputviewport_p.h"
 #include "wtools.h"
 #include "wquickbackend_p.h"
 #include "wwaylandcompositor_p.h"
@@ -28,6 +29,14 @@
 #include <QOffscreenSurface>
 #include <QQuickRenderControl>
 #include <QOpenGLFunctions>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QAnimationDriver>
+#include <QLoggingCategory>
+#include <QMetaEnum>
+
+#include <array>
+#include <algorithm>
 
 #define protected public
 #define private public
@@ -67,6 +76,8 @@ extern "C" {
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(qLcOutputIdle, "waylib.server.output.idle", QtWarningMsg)
+
 struct Q_DECL_HIDDEN QScopedPointerPixmanRegion32Deleter {
     static inline void cleanup(pixman_region32_t *pointer) {
         if (pointer)
@@ -92,9 +103,19 @@ public:
     }
 
     inline void init() {
-        connect(this, &OutputHelper::requestRender, renderWindow(), &WOutputRenderWindow::render);
-        connect(this, &OutputHelper::damaged, renderWindow(), &WOutputRenderWindow::scheduleRender);
+        m_renderDelayTimer.setSingleShot(true);
+        m_renderDelayTimer.setTimerType(Qt::PreciseTimer);
+        connect(&m_renderDelayTimer, &QTimer::timeout, renderWindow(), &WOutputRenderWindow::render);
+        connect(this, &OutputHelper::requestRender, this, &OutputHelper::onRequestRender);
+        connect(this, &OutputHelper::damaged, this, &OutputHelper::onDamaged);
+        connect(this, &OutputHelper::needsFrameChanged, this, &OutputHelper::onNeedsFrameChanged);
         connect(output()->output(), &WOutput::scaleChanged, this, &OutputHelper::updateSceneDPR);
+        connect(qwoutput(), &QWOutput::present, this, [this] (wlr_output_event_present *event) {
+            if (!event->presented || !event->when)
+                return;
+            m_lastPresent = event->when->tv_sec * 1000000000ll + event->when->tv_nsec;
+            m_presentRefresh = event->refresh;
+        });
     }
 
     inline QWOutput *qwoutput() const {
@@ -115,9 +136,112 @@ public:
 
     void updateSceneDPR();
 
+    // The output will present a frame, it's not disabled (e.g. DPMS off) and visible
+    inline bool canPresent() const {
+        return output()->isVisible() && qwoutput()->handle()->enabled;
+    }
+
+    // The render is delayed after the frame event, to start it just before the
+    // deadline of the next vblank, see WOutputViewport::delayRender
+    inline bool isRenderDelayed() const {
+        return m_renderDelayTimer.isActive();
+    }
+    // Maybe started before polishing the items, keep that start time
+    inline void beginRenderTiming() {
+        if (!m_renderTiming.isValid())
+            m_renderTiming.start();
+    }
+    inline void cancelRenderTiming() {
+        m_renderTiming.invalidate();
+    }
+    void endRenderTiming();
+    // usecs after the frame event, rounded down to msecs for QTimer
+    int renderDelay() const;
+    // CLOCK_MONOTONIC nsecs of the next vblank after now, predicted by
+    // the last presentation, or now if it's unknown
+    qint64 predictNextPresent(qint64 now) const;
+    // CLOCK_MONOTONIC nsecs of the render start of the frame after the
+    // committed frame, 0 if it's unknown
+    qint64 predictNextRender(qint64 now) const;
+    // Same as predictNextRender, but the delayed render is already scheduled
+    inline qint64 nextRenderTime(qint64 now) const {
+        if (isRenderDelayed())
+            return now + m_renderDelayTimer.remainingTime() * 1000000ll;
+        return predictNextRender(now);
+    }
+
+    // The damage of the cursors in the output, logical coordinates, it's
+    // only the damage of this frame if the content isn't dirty
+    inline const QRegion &cursorDamage() const {
+        return m_cursorDamage;
+    }
+    inline void addCursorDamage(const QRegion &damage) {
+        m_cursorDamage |= damage;
+    }
+    inline void clearCursorDamage() {
+        m_cursorDamage = QRegion();
+    }
+
 private:
+    void onRequestRender();
+    void onDamaged();
+    void onNeedsFrameChanged();
+
     QPointer<WOutputViewport> m_output;
     QWDamageRing m_damageRing;
+
+    QTimer m_renderDelayTimer;
+    QElapsedTimer m_renderTiming;
+    // usecs, from acquire the render target to commit
+    std::array<int, 64> m_renderDurations;
+    int m_renderDurationCount = 0;
+    int m_renderDurationIndex = 0;
+
+    qint64 m_lastPresent = 0;
+    qint64 m_presentRefresh = 0;
+
+    QRegion m_cursorDamage;
+};
+
+// Advance the animations by the frame of output instead of a timer. It's
+// only ticking in the rendering of output while any animation is running,
+// the animation time is the predicted presentation time of the frame.
+class AnimationDriver : public QAnimationDriver
+{
+public:
+    AnimationDriver(WOutputRenderWindow *window)
+        : QAnimationDriver(window)
+        , m_window(window)
+    {
+        m_clock.start();
+    }
+
+    void start() override {
+        QAnimationDriver::start();
+        // Let the output emit frame event
+        m_window->scheduleRender();
+    }
+
+    qint64 elapsed() const override {
+        // Query out of tick, e.g. the start time of a new animation
+        if (!m_ticking)
+            return qMax(m_time, m_clock.elapsed());
+        return m_time;
+    }
+
+    void advanceTo(qint64 presentTime) {
+        const qint64 time = presentTime / 1000000 - m_clock.msecsSinceReference();
+        m_time = qMax(m_time, time);
+        m_ticking = true;
+        advance();
+        m_ticking = false;
+    }
+
+private:
+    WOutputRenderWindow *m_window;
+    QElapsedTimer m_clock;
+    qint64 m_time = 0;
+    bool m_ticking = false;
 };
 
 class RenderControl : public QQuickRenderControl
@@ -254,6 +378,8 @@ public:
     void updateSceneDPR();
 
     void doRender();
+    OutputHelper *presentableOutput() const;
+    void collectCursorDamage();
     inline void scheduleDoRender() {
         if (!isInitialized())
             return; // Not initialized
@@ -261,6 +387,15 @@ public:
         QCoreApplication::postEvent(q_func(), new QEvent(doRenderEventType));
     }
 
+    inline void recordWakeup(WOutputRenderWindow::WakeupSource source) {
+        ++wakeupCounts[source];
+        pendingWakeups |= 1u << source;
+    }
+    void onSceneChanged(WOutputRenderWindow::WakeupSource source);
+    bool onCursorChanged();
+    bool isVisibleSceneChange() const;
+    void reportIdleWakeup(bool committed);
+
     Q_DECLARE_PUBLIC(WOutputRenderWindow)
 
     WWaylandCompositor *compositor = nullptr;
@@ -269,6 +404,20 @@ public:
 
     std::unique_ptr<RenderContextProxy> renderContextProxy;
     QOpenGLContext *glContext = nullptr;
+    AnimationDriver *animationDriver = nullptr;
+    // Tick the animations without damage, wlr_output_schedule_frame would
+    // emit the frame at once if the output has no pending commit
+    QTimer *animationTimer = nullptr;
+
+    bool strictIdle = false;
+    // The bits of WakeupSource since the last doRender
+    uint pendingWakeups = 0;
+    std::array<quint64, WOutputRenderWindow::Cursor + 1> wakeupCounts {};
+    quint64 renderCount = 0;
+    quint64 commitCount = 0;
+    quint64 emptyCommitCount = 0;
+    quint64 idleWakeupCount = 0;
+    quint64 ignoredSceneChangeCount = 0;
 #ifdef ENABLE_VULKAN_RENDER
     QScopedPointer<QVulkanInstance> vkInstance;
 #endif
@@ -279,6 +428,83 @@ void OutputHelper::updateSceneDPR()
     WOutputRenderWindowPrivate::get(renderWindow())->updateSceneDPR();
 }
 
+void OutputHelper::endRenderTiming()
+{
+    if (!m_renderTiming.isValid())
+        return;
+
+    m_renderDurations[m_renderDurationIndex] = m_renderTiming.nsecsElapsed() / 1000;
+    m_renderDurationIndex = (m_renderDurationIndex + 1) % m_renderDurations.size();
+    m_renderDurationCount = qMin<int>(m_renderDurationCount + 1, m_renderDurations.size());
+    m_renderTiming.invalidate();
+}
+
+int OutputHelper::renderDelay() const
+{
+    if (!m_output || !m_output->delayRender() || m_renderDurationCount < 8)
+        return 0;
+
+    // mHz
+    const int refresh = qwoutput()->handle()->refresh;
+    if (refresh <= 0)
+        return 0;
+
+    // The 95th percentile of the recent render durations
+    std::array<int, 64> durations = m_renderDurations;
+    auto end = durations.begin() + m_renderDurationCount;
+    auto percentile = durations.begin() + (m_renderDurationCount * 95 / 100);
+    std::nth_element(durations.begin(), percentile, end);
+
+    const qint64 interval = 1000000000ll / refresh;
+    const qint64 delay = interval - *percentile - m_output->renderSafetyMargin() * 1000;
+    // QTimer is msecs precision, round down to not miss the deadline
+    return delay > 0 ? delay / 1000 * 1000 : 0;
+}
+
+qint64 OutputHelper::predictNextPresent(qint64 now) const
+{
+    if (m_lastPresent <= 0 || m_presentRefresh <= 0 || m_lastPresent > now)
+        return now;
+
+    const qint64 frames = (now - m_lastPresent) / m_presentRefresh + 1;
+    return m_lastPresent + frames * m_presentRefresh;
+}
+
+qint64 OutputHelper::predictNextRender(qint64 now) const
+{
+    const qint64 present = predictNextPresent(now);
+    if (present <= now)
+        return 0;
+
+    // The frame event comes at the vblank of the committed frame
+    return present + renderDelay() * 1000ll;
+}
+
+void OutputHelper::onRequestRender()
+{
+    WOutputRenderWindowPrivate::get(renderWindow())->recordWakeup(WOutputRenderWindow::FrameEvent);
+    const int delay = renderDelay() / 1000;
+    if (delay > 0) {
+        // The client commits in this time will be in the current frame
+        m_renderDelayTimer.start(delay);
+    } else {
+        m_renderDelayTimer.stop();
+        renderWindow()->render();
+    }
+}
+
+void OutputHelper::onDamaged()
+{
+    WOutputRenderWindowPrivate::get(renderWindow())->recordWakeup(WOutputRenderWindow::Damage);
+    renderWindow()->scheduleRender();
+}
+
+void OutputHelper::onNeedsFrameChanged()
+{
+    if (needsFrame())
+        WOutputRenderWindowPrivate::get(renderWindow())->recordWakeup(WOutputRenderWindow::NeedsFrame);
+}
+
 QSGRendererInterface::GraphicsApi WOutputRenderWindowPrivate::graphicsApi() const
 {
     auto api = WOutputHelper::getGraphicsApi(rc());
@@ -298,6 +524,30 @@ void WOutputRenderWindowPrivate::init()
     q->create();
     rc()->m_renderWindow = q;
 
+    if (!qEnvironmentVariableIsSet("WAYLIB_DISABLE_OUTPUT_ANIMATION_DRIVER")) {
+        animationDriver = new AnimationDriver(q);
+        animationDriver->install();
+
+        animationTimer = new QTimer(q);
+        animationTimer->setSingleShot(true);
+        animationTimer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(animationTimer, &QTimer::timeout, q, [this] {
+            if (presentableOutput()) {
+                recordWakeup(WOutputRenderWindow::Animation);
+                scheduleDoRender();
+                return;
+            }
+
+            // No output presents the frames, only tick the animations by the
+            // clock as the default driver, don't wake up the rendering
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            animationDriver->advanceTo(now.tv_sec * 1000000000ll + now.tv_nsec);
+            if (animationDriver->isRunning())
+                animationTimer->start(16);
+        });
+    }
+
     // Configure the QSGRenderer at QSGRenderContext::renderNextFrame
     QObject::connect(q, &WOutputRenderWindow::beforeRendering, q, [this] {
         context = renderContextProxy.get();
@@ -326,10 +576,122 @@ void WOutputRenderWindowPrivate::init()
     7. QQuickRenderControl::sceneChanged
     */
     // TODO: Get damage regions from the Qt, and use WOutputDamage::add instead of WOutput::update.
-    QObject::connect(rc(), &QQuickRenderControl::renderRequested,
-                     q, &WOutputRenderWindow::update);
-    QObject::connect(rc(), &QQuickRenderControl::sceneChanged,
-                     q, &WOutputRenderWindow::update);
+    QObject::connect(rc(), &QQuickRenderControl::renderRequested, q, [this] {
+        onSceneChanged(WOutputRenderWindow::RenderRequested);
+    });
+    QObject::connect(rc(), &QQuickRenderControl::sceneChanged, q, [this] {
+        onSceneChanged(WOutputRenderWindow::SceneChanged);
+    });
+}
+
+void WOutputRenderWindowPrivate::onSceneChanged(WOutputRenderWindow::WakeupSource source)
+{
+    if (source == WOutputRenderWindow::SceneChanged && onCursorChanged())
+        return;
+
+    // The renderRequested is for the render without sync, e.g. the animators
+    if (strictIdle && source == WOutputRenderWindow::SceneChanged && !isVisibleSceneChange()) {
+        ++ignoredSceneChangeCount;
+        return;
+    }
+
+    recordWakeup(source);
+    q_func()->update();
+}
+
+bool WOutputRenderWindowPrivate::onCursorChanged()
+{
+    if (!dirtyItemList || !itemsToPolish.isEmpty())
+        return false;
+
+    for (QQuickItem *item = dirtyItemList; item; item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        if (!OutputCursorItem::from(item))
+            return false;
+    }
+
+    // The sceneChanged is only emitted when the cursor is added to the dirty
+    // list, the damage is collected in doRender for the later moves
+    recordWakeup(WOutputRenderWindow::Cursor);
+    scheduleDoRender();
+
+    return true;
+}
+
+void WOutputRenderWindowPrivate::collectCursorDamage()
+{
+    Q_Q(WOutputRenderWindow);
+
+    QRegion damage;
+    const auto cursors = OutputCursorItem::instances();
+    for (auto cursor : cursors) {
+        if (cursor->window() == q)
+            damage |= cursor->takeDamage();
+    }
+
+    if (damage.isEmpty())
+        return;
+
+    for (OutputHelper *helper : std::as_const(outputs)) {
+        auto viewport = helper->output();
+        const QRectF rect = viewport->mapRectToScene(QRectF(QPointF(0, 0), viewport->size()));
+        const QRegion outputDamage = damage & rect.toAlignedRect();
+        if (!outputDamage.isEmpty())
+            helper->addCursorDamage(outputDamage.translated(-rect.topLeft().toPoint()));
+    }
+}
+
+static bool isVisibleChange(QQuickItem *item)
+{
+    auto d = QQuickItemPrivate::get(item);
+    if (d->effectiveVisible)
+        return true;
+    // Used by a ShaderEffectSource, or the visibility or parent is changed
+    if (d->extra.isAllocated() && d->extra->effectRefCount > 0)
+        return true;
+    return d->dirtyAttributes & (QQuickItemPrivate::Visible
+                                 | QQuickItemPrivate::HideReference
+                                 | QQuickItemPrivate::ParentChanged
+                                 | QQuickItemPrivate::Window);
+}
+
+bool WOutputRenderWindowPrivate::isVisibleSceneChange() const
+{
+    // Not caused by any item, e.g. QQuickWindow::update
+    if (!dirtyItemList && itemsToPolish.isEmpty())
+        return true;
+
+    for (QQuickItem *item = dirtyItemList; item; item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        if (isVisibleChange(item))
+            return true;
+    }
+
+    for (QQuickItem *item : itemsToPolish) {
+        if (isVisibleChange(item))
+            return true;
+    }
+
+    return false;
+}
+
+void WOutputRenderWindowPrivate::reportIdleWakeup(bool committed)
+{
+    if (committed)
+        ++emptyCommitCount;
+    else
+        ++idleWakeupCount;
+
+    if (!qLcOutputIdle().isDebugEnabled())
+        return;
+
+    const QMetaEnum sources = QMetaEnum::fromType<WOutputRenderWindow::WakeupSource>();
+    QByteArrayList names;
+    for (int i = 0; i < sources.keyCount(); ++i) {
+        if (pendingWakeups & (1u << sources.value(i)))
+            names << sources.key(i);
+    }
+
+    qCDebug(qLcOutputIdle) << (committed ? "Commit without render, woken by" : "Render loop woken without work by")
+                           << (names.isEmpty() ? QByteArray("scheduleRender") : names.join('|'));
 }
 
 void WOutputRenderWindowPrivate::init(OutputHelper *helper)
@@ -458,33 +820,75 @@ struct PixmanRegion
 
 void WOutputRenderWindowPrivate::doRender()
 {
+    OutputHelper *animationOutput = nullptr;
+    if (animationDriver && animationDriver->isRunning()) {
+        for (OutputHelper *helper : std::as_const(outputs)) {
+            if (!helper->renderable() || !helper->output()->isVisible()
+                || helper->isRenderDelayed())
+                continue;
+
+            animationOutput = helper;
+            break;
+        }
+
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const qint64 nowNsecs = now.tv_sec * 1000000000ll + now.tv_nsec;
+        // No output will present this frame, e.g. all are disabled, advance by the clock
+        animationDriver->advanceTo(animationOutput ? animationOutput->predictNextPresent(nowNsecs) : nowNsecs);
+    }
+
+    // From the rectangles of the last rendered to the current
+    collectCursorDamage();
+
     bool needPolishItems = true;
+    bool rendered = false;
+    bool committed = false;
     for (OutputHelper *helper : outputs) {
-        if (!helper->renderable() || !helper->output()->isVisible())
+        if (!helper->renderable() || !helper->output()->isVisible()
+            || helper->isRenderDelayed())
+            continue;
+
+        if (strictIdle && !helper->contentIsDirty() && helper->cursorDamage().isEmpty()
+            && !helper->needsFrame())
             continue;
 
         if (needPolishItems) {
+            // The polish is a part of the render of the first output, e.g. the
+            // commits of surfaces are applied in polishing
+            helper->beginRenderTiming();
             rc()->polishItems();
             needPolishItems = false;
         }
 
-        if (!helper->contentIsDirty()) {
+        // Only the cursors are changed, the damage of output is the cursors'
+        const bool onlyCursorDamage = !helper->contentIsDirty() && !helper->cursorDamage().isEmpty();
+        if (!helper->contentIsDirty() && !onlyCursorDamage) {
+            helper->cancelRenderTiming();
             if (helper->needsFrame()) {
-                if (helper->qwoutput()->commit())
+                if (helper->qwoutput()->commit()) {
                     helper->resetState();
+                    committed = true;
+                    ++commitCount;
+                }
             }
             continue;
         }
 
+        helper->beginRenderTiming();
         const auto lastRT = helper->lastRenderTarget();
         int bufferAge = 0;
         auto rt = helper->acquireRenderTarget(rc(), &bufferAge);
         Q_ASSERT(rt.first);
-        if (rt.second.isNull())
+        if (rt.second.isNull()) {
+            helper->cancelRenderTiming();
             continue;
+        }
 
-        if (Q_UNLIKELY(!helper->makeCurrent(rt.first, glContext)))
+        if (Q_UNLIKELY(!helper->makeCurrent(rt.first, glContext))) {
+            helper->cancelRenderTiming();
             continue;
+        }
 
         {
             q_func()->setRenderTarget(rt.second);
@@ -586,19 +990,71 @@ void WOutputRenderWindowPrivate::doRender()
                 helper->damageRing()->add(scaledFlushDamage);
                 if (!softwareRenderer->flushRegion().isEmpty())
                     helper->qwoutput()->setDamage(&helper->damageRing()->handle()->current);
+            } else if (onlyCursorDamage) {
+                const auto scaleTF = QTransform::fromScale(devicePixelRatio, devicePixelRatio);
+                PixmanRegion cursorDamage;
+                bool ok = WTools::toPixmanRegion(scaleTF.map(helper->cursorDamage()), cursorDamage);
+                Q_ASSERT(ok);
+                helper->damageRing()->setBounds(pixelSize);
+                helper->damageRing()->add(cursorDamage);
+                helper->qwoutput()->setDamage(&helper->damageRing()->handle()->current);
             }
+            helper->clearCursorDamage();
 
             if (QSGRendererInterface::isApiRhiBased(WOutputHelper::getGraphicsApi()))
                 rc()->endFrame();
         }
 
-        if (helper->qwoutput()->commit())
+        rendered = true;
+        ++renderCount;
+        if (helper->qwoutput()->commit()) {
             helper->resetState();
+            committed = true;
+            ++commitCount;
+        }
+        helper->endRenderTiming();
         helper->doneCurrent(glContext);
         helper->damageRing()->rotate();
 
+        if (helper->output()->predictiveFrameCallback()) {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            WOutputViewportPrivate::get(helper->output())->nextRenderTime =
+                helper->predictNextRender(now.tv_sec * 1000000000ll + now.tv_nsec);
+        }
         Q_EMIT helper->output()->frameDone();
     }
+
+    if (animationDriver && animationDriver->isRunning()) {
+        // Keep the frame events coming while animating, even if nothing is damaged
+        if (OutputHelper *helper = presentableOutput()) {
+            if (committed) {
+                helper->qwoutput()->scheduleFrame();
+            } else {
+                const int interval = helper->output()->refreshInterval();
+                animationTimer->start(interval > 0 ? interval : 16);
+            }
+        } else {
+            // Tick the animations by the clock until an output can present
+            animationTimer->start(16);
+        }
+    }
+
+    if (!rendered && pendingWakeups)
+        reportIdleWakeup(committed);
+    pendingWakeups = 0;
+
+    Q_EMIT q_func()->renderFinished();
+}
+
+OutputHelper *WOutputRenderWindowPrivate::presentableOutput() const
+{
+    for (OutputHelper *helper : std::as_const(outputs)) {
+        if (helper->canPresent())
+            return helper;
+    }
+
+    return nullptr;
 }
 
 // TODO: Support QWindow::setCursor
@@ -693,6 +1149,71 @@ void WOutputRenderWindow::setCompositor(WWaylandCompositor *newCompositor)
     }
 }
 
+bool WOutputRenderWindow::strictIdle() const
+{
+    Q_D(const WOutputRenderWindow);
+    return d->strictIdle;
+}
+
+void WOutputRenderWindow::setStrictIdle(bool newStrictIdle)
+{
+    Q_D(WOutputRenderWindow);
+    if (d->strictIdle == newStrictIdle)
+        return;
+    d->strictIdle = newStrictIdle;
+    Q_EMIT strictIdleChanged();
+}
+
+QVariantMap WOutputRenderWindow::idleStatistics() const
+{
+    Q_D(const WOutputRenderWindow);
+
+    QVariantMap statistics {
+        {QStringLiteral("renders"), d->renderCount},
+        {QStringLiteral("commits"), d->commitCount},
+        {QStringLiteral("emptyCommits"), d->emptyCommitCount},
+        {QStringLiteral("idleWakeups"), d->idleWakeupCount},
+        {QStringLiteral("ignoredSceneChanges"), d->ignoredSceneChangeCount},
+    };
+
+    const QMetaEnum sources = QMetaEnum::fromType<WakeupSource>();
+    for (int i = 0; i < sources.keyCount(); ++i)
+        statistics.insert(QString::fromLatin1(sources.key(i)), d->wakeupCounts[sources.value(i)]);
+
+    return statistics;
+}
+
+void WOutputRenderWindow::resetIdleStatistics()
+{
+    Q_D(WOutputRenderWindow);
+    d->wakeupCounts.fill(0);
+    d->renderCount = 0;
+    d->commitCount = 0;
+    d->emptyCommitCount = 0;
+    d->idleWakeupCount = 0;
+    d->ignoredSceneChangeCount = 0;
+}
+
+qint64 WOutputRenderWindow::nextRenderTime() const
+{
+    Q_D(const WOutputRenderWindow);
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const qint64 nowNsecs = now.tv_sec * 1000000000ll + now.tv_nsec;
+
+    qint64 time = 0;
+    for (OutputHelper *helper : d->outputs) {
+        if (!helper->output()->isVisible())
+            continue;
+        const qint64 t = helper->nextRenderTime(nowNsecs);
+        if (t > 0 && (time == 0 || t < time))
+            time = t;
+    }
+
+    return time;
+}
+
 void WOutputRenderWindow::render()
 {
     Q_D(WOutputRenderWindow);
@@ -22,10 +22,22 @@ class WAYLIB_SERVER_EXPORT WOutputRenderWindow : public QQuickWindow, public QQm
     Q_OBJECT
     Q_DECLARE_PRIVATE(WOutputRenderWindow)
     Q_PROPERTY(WWaylandCompositor *compositor READ compositor WRITE setCompositor REQUIRED)
+    Q_PROPERTY(bool strictIdle READ strictIdle WRITE setStrictIdle NOTIFY strictIdleChanged FINAL)
     QML_NAMED_ELEMENT(OutputRenderWindow)
     Q_INTERFACES(QQmlParserStatus)
 
 public:
+    enum WakeupSource {
+        FrameEvent,
+        Damage,
+        NeedsFrame,
+        SceneChanged,
+        RenderRequested,
+        Animation,
+        Cursor
+    };
+    Q_ENUM(WakeupSource)
+
     explicit WOutputRenderWindow(QObject *parent = nullptr);
     ~WOutputRenderWindow();
 
@@ -37,11 +49,32 @@ public:
     WWaylandCompositor *compositor() const;
     void setCompositor(WWaylandCompositor *newRenderer);
 
+    // Ignore the scene changes of the invisible items, and don't polish
+    // when no output is dirty or requests a frame, so an idle desktop
+    // does no render work and no commit.
+    bool strictIdle() const;
+    void setStrictIdle(bool newStrictIdle);
+
+    // The counts of every WakeupSource, and "renders", "commits",
+    // "emptyCommits", "idleWakeups", "ignoredSceneChanges"
+    Q_INVOKABLE QVariantMap idleStatistics() const;
+    Q_INVOKABLE void resetIdleStatistics();
+
+    // CLOCK_MONOTONIC nsecs, the earliest predicted start of the next render
+    // of the outputs, 0 if unknown
+    qint64 nextRenderTime() const;
+
 public Q_SLOTS:
     void render();
     void scheduleRender();
     void update();
 
+Q_SIGNALS:
+    void strictIdleChanged();
+    // Emitted at the end of every render pass, the time until nextRenderTime
+    // is free for the other work of the frame, e.g. incubating QML objects
+    void renderFinished();
+
 private:
     void classBegin() override;
     void componentComplete() override;
@@ -7,12 +7,17 @@
 #include "woutputlayout.h"
 #include "wquickseat_p.h"
 #include "wseat.h"
+#include "wcursor.h"
 #include "wtools.h"
+#include "wxcursorthemecache_p.h"
 
+#include <QSGImageNode>
 #include <private/qsgplaintexture_p.h>
 
 extern "C" {
 #include <wlr/render/wlr_texture.h>
+#include <wlr/types/wlr_xcursor_manager.h>
+#include <wlr/xcursor.h>
 #define static
 #include <wlr/render/gles2.h>
 #undef static
@@ -51,6 +56,113 @@ QImage CursorTextureFactory::image() const
     return WTools::fromPixmanImage(image);
 }
 
+static const char *const commonCursorShapes[] = {
+    "default", "left_ptr", "text", "xterm", "pointer", "hand2", "grabbing",
+    "wait", "left_ptr_watch", "top_side", "bottom_side", "left_side", "right_side",
+    "top_left_corner", "top_right_corner", "bottom_left_corner", "bottom_right_corner",
+    "n-resize", "s-resize", "w-resize", "e-resize",
+    "nw-resize", "ne-resize", "sw-resize", "se-resize",
+};
+
+CursorTextureCache::CursorTextureCache(QQuickWindow *window)
+    : QObject(window)
+    , m_window(window)
+{
+    // The scene graph resources are released before the window destroyed
+    connect(window, &QQuickWindow::sceneGraphInvalidated, this, &CursorTextureCache::clear);
+    connect(WXCursorThemeCache::instance(), &WXCursorThemeCache::themeLoaded,
+            this, &CursorTextureCache::preload);
+}
+
+CursorTextureCache::~CursorTextureCache()
+{
+    clear();
+}
+
+CursorTextureCache *CursorTextureCache::get(QQuickWindow *window)
+{
+    if (auto cache = window->findChild<CursorTextureCache*>(QString(), Qt::FindDirectChildrenOnly))
+        return cache;
+    return new CursorTextureCache(window);
+}
+
+QSGTexture *CursorTextureCache::texture(QWXCursorManager *manager, const QByteArray &name, float scale, int frame)
+{
+    auto handle = manager->handle();
+    CursorTextureKey key { handle->name, handle->size, name, scale, frame };
+    if (auto texture = m_textures.value(key))
+        return texture;
+
+    preload(manager, scale);
+    if (auto texture = m_textures.value(key))
+        return texture;
+
+    return load(manager, key);
+}
+
+void CursorTextureCache::preload(QWXCursorManager *manager, float scale)
+{
+    auto themeCache = WXCursorThemeCache::instance();
+    auto handle = manager->handle();
+    CursorTextureKey key { handle->name, handle->size, {}, scale };
+    if (m_preloaded.contains(key))
+        return;
+
+    // Not decoded yet, or the theme is released
+    if (themeCache->frames(manager, commonCursorShapes[0], scale).isEmpty()
+        && themeCache->frames(manager, commonCursorShapes[1], scale).isEmpty())
+        return;
+
+    m_preloaded.insert(key);
+    for (auto shape : commonCursorShapes) {
+        key.name = shape;
+        const int count = themeCache->frames(manager, key.name, scale).size();
+        for (key.frame = 0; key.frame < count; ++key.frame) {
+            if (!m_textures.contains(key))
+                load(manager, key);
+        }
+    }
+}
+
+QSGTexture *CursorTextureCache::load(QWXCursorManager *manager, const CursorTextureKey &key)
+{
+    QImage image;
+    const auto frames = WXCursorThemeCache::instance()->frames(manager, key.name, key.scale);
+    if (key.frame < frames.size()) {
+        image = frames.at(key.frame).image;
+    } else if (key.frame == 0) {
+        // Not decoded yet, it's same as the image used by wlr_cursor_set_xcursor
+        auto handle = manager->handle();
+        if (!wlr_xcursor_manager_load(handle, key.scale))
+            return nullptr;
+
+        auto xcursor = wlr_xcursor_manager_get_xcursor(handle, key.name.constData(), key.scale);
+        if (!xcursor || xcursor->image_count == 0)
+            return nullptr;
+
+        auto xcursorImage = xcursor->images[0];
+        // The images are released with the xcursor manager
+        image = QImage(xcursorImage->buffer, xcursorImage->width, xcursorImage->height,
+                       xcursorImage->width * 4, QImage::Format_ARGB32_Premultiplied).copy();
+    }
+
+    if (image.isNull())
+        return nullptr;
+
+    auto texture = m_window->createTextureFromImage(image, QQuickWindow::TextureHasAlphaChannel);
+    if (texture)
+        m_textures.insert(key, texture);
+
+    return texture;
+}
+
+void CursorTextureCache::clear()
+{
+    qDeleteAll(m_textures);
+    m_textures.clear();
+    m_preloaded.clear();
+}
+
 QuickOutputCursor::QuickOutputCursor(QObject *parent)
     : QObject(parent)
 {
@@ -191,6 +303,37 @@ void QuickOutputCursor::setSourceRect(const QRectF &newSourceRect)
     emit sourceRectChanged();
 }
 
+QWTexture *QuickOutputCursor::texture() const
+{
+    return lastTexture ? QWTexture::from(lastTexture) : nullptr;
+}
+
+QWXCursorManager *QuickOutputCursor::xcursorManager() const
+{
+    return m_xcursorManager;
+}
+
+QByteArray QuickOutputCursor::xcursorName() const
+{
+    return m_xcursorName;
+}
+
+float QuickOutputCursor::xcursorScale() const
+{
+    return m_xcursorScale;
+}
+
+void QuickOutputCursor::setXCursor(QWXCursorManager *manager, const QByteArray &name, float scale)
+{
+    if (m_xcursorManager == manager && m_xcursorName == name && qFuzzyCompare(m_xcursorScale, scale))
+        return;
+
+    m_xcursorManager = manager;
+    m_xcursorName = name;
+    m_xcursorScale = scale;
+    Q_EMIT xcursorChanged();
+}
+
 void QuickOutputCursor::setPosition(const QPointF &pos)
 {
     delegateItem->setPosition(delegateItem->parentItem()->mapFromGlobal(pos));
@@ -201,6 +344,168 @@ void QuickOutputCursor::setDelegateItem(QQuickItem *item)
     delegateItem = item;
 }
 
+static QList<OutputCursorItem*> cursorItems;
+
+OutputCursorItem::OutputCursorItem(QuickOutputCursor *cursor, QQuickItem *parent)
+    : QQuickItem(parent)
+    , m_cursor(cursor)
+{
+    cursorItems.append(this);
+    setFlag(ItemHasContents);
+    updateVisible();
+
+    QObject::connect(cursor, &QuickOutputCursor::visibleChanged, this, &OutputCursorItem::updateVisible);
+    QObject::connect(cursor, &QuickOutputCursor::isHardwareCursorChanged, this, &OutputCursorItem::updateVisible);
+    QObject::connect(cursor, &QuickOutputCursor::imageSourceChanged, this, [this] {
+        m_textureDirty = true;
+        update();
+    });
+    QObject::connect(cursor, &QuickOutputCursor::xcursorChanged, this, &OutputCursorItem::update);
+    QObject::connect(cursor, &QuickOutputCursor::xcursorChanged, this, &OutputCursorItem::updateAnimation);
+    QObject::connect(this, &QQuickItem::visibleChanged, this, &OutputCursorItem::updateAnimation);
+    QObject::connect(WXCursorThemeCache::instance(), &WXCursorThemeCache::themeLoaded,
+                     this, &OutputCursorItem::updateAnimation);
+    QObject::connect(cursor, &QuickOutputCursor::hotspotChanged, this, &OutputCursorItem::update);
+    QObject::connect(cursor, &QuickOutputCursor::sizeChanged, this, &OutputCursorItem::update);
+    QObject::connect(cursor, &QuickOutputCursor::sourceRectChanged, this, &OutputCursorItem::update);
+}
+
+OutputCursorItem::~OutputCursorItem()
+{
+    cursorItems.removeOne(this);
+}
+
+const QList<OutputCursorItem*> &OutputCursorItem::instances()
+{
+    return cursorItems;
+}
+
+QRegion OutputCursorItem::takeDamage()
+{
+    const QRect rect = isVisible() ? mapRectToScene(cursorRect()).toAlignedRect() : QRect();
+    // The texture is changed, it's cleared in the sync of rendering
+    const bool contentDirty = QQuickItemPrivate::get(this)->dirtyAttributes & QQuickItemPrivate::Content;
+    if (rect == m_lastRect && !contentDirty)
+        return QRegion();
+
+    QRegion damage(rect);
+    damage |= m_lastRect;
+    m_lastRect = rect;
+
+    return damage;
+}
+
+QSGNode *OutputCursorItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto node = static_cast<QSGImageNode*>(oldNode);
+    auto texture = m_cursor->texture();
+    if (!texture) {
+        delete node;
+        return nullptr;
+    }
+
+    if (!node) {
+        node = window()->createImageNode();
+        node->setOwnsTexture(true);
+        m_textureDirty = true;
+    }
+
+    QSGTexture *cachedTexture = nullptr;
+    if (auto manager = m_cursor->xcursorManager())
+        cachedTexture = CursorTextureCache::get(window())->texture(manager, m_cursor->xcursorName(),
+                                                                   m_cursor->xcursorScale(), m_frame);
+
+    if (cachedTexture) {
+        m_textureDirty = false;
+        if (node->texture() != cachedTexture) {
+            // Release the old texture if it's owned
+            node->setTexture(cachedTexture);
+            node->setOwnsTexture(false);
+        }
+    } else if (m_textureDirty || !node->ownsTexture()) {
+        m_textureDirty = false;
+        CursorTextureFactory factory(texture);
+        auto sgTexture = factory.createTexture(window());
+        if (!sgTexture) {
+            delete node;
+            return nullptr;
+        }
+        node->setTexture(sgTexture);
+        node->setOwnsTexture(true);
+    }
+
+    const QRectF sourceRect = m_cursor->sourceRect();
+    node->setSourceRect(sourceRect.isEmpty() ? QRectF(QPointF(0, 0), node->texture()->textureSize()) : sourceRect);
+    node->setRect(cursorRect());
+
+    return node;
+}
+
+QRectF OutputCursorItem::cursorRect() const
+{
+    return QRectF(-m_cursor->hotspot(), m_cursor->size());
+}
+
+void OutputCursorItem::updateVisible()
+{
+    setVisible(m_cursor->visible() && !m_cursor->isHardwareCursor());
+}
+
+void OutputCursorItem::updateAnimation()
+{
+    WXCursorThemeCache::Frames frames;
+    if (auto manager = m_cursor->xcursorManager())
+        frames = WXCursorThemeCache::instance()->frames(manager, m_cursor->xcursorName(), m_cursor->xcursorScale());
+
+    m_frameDelays.clear();
+    int duration = 0;
+    for (const auto &frame : std::as_const(frames)) {
+        m_frameDelays.append(qMax(frame.delay, 1));
+        duration += m_frameDelays.last();
+    }
+
+    if (m_frame != 0) {
+        m_frame = 0;
+        update();
+    }
+
+    if (frames.size() < 2 || !isVisible()) {
+        if (m_animation)
+            m_animation->stop();
+        return;
+    }
+
+    if (!m_animation) {
+        m_animation = new QVariantAnimation(this);
+        m_animation->setStartValue(0);
+        m_animation->setLoopCount(-1);
+        QObject::connect(m_animation, &QVariantAnimation::valueChanged, this, [this] (const QVariant &value) {
+            setFrameTime(value.toInt());
+        });
+    }
+
+    m_animation->stop();
+    m_animation->setEndValue(duration);
+    m_animation->setDuration(duration);
+    m_animation->start();
+}
+
+void OutputCursorItem::setFrameTime(int time)
+{
+    int frame = 0;
+    for (; frame < m_frameDelays.size() - 1; ++frame) {
+        time -= m_frameDelays.at(frame);
+        if (time < 0)
+            break;
+    }
+
+    if (m_frame == frame)
+        return;
+
+    m_frame = frame;
+    update();
+}
+
 QQuickTextureFactory *CursorProvider::requestTexture(const QString &id, QSize *size, const QSize &requestedSize)
 {
     Q_UNUSED(requestedSize);
@@ -285,27 +590,43 @@ void WOutputViewportPrivate::clearCursors()
 
 void WOutputViewportPrivate::updateCursors()
 {
-    if (!output || !cursorDelegate)
+    if (!output)
         return;
 
     W_Q(WOutputViewport);
 
+    // Only if one cursor is on the output, the image of its wlr_output_cursor is known
+    QWXCursorManager *xcursorManager = nullptr;
+    QByteArray xcursorName;
+    const auto cursorList = output->cursorList();
+    if (cursorList.size() == 1 && cursorList.first()->xcursorManager()) {
+        xcursorName = cursorList.first()->xcursorName();
+        if (!xcursorName.isEmpty())
+            xcursorManager = cursorList.first()->xcursorManager();
+    }
+
     int index = 0;
     struct wlr_output_cursor *cursor;
     wl_list_for_each(cursor, &output->handle()->handle()->cursors, link) {
         QuickOutputCursor *quickCursor = nullptr;
         if (index >= cursors.count()) {
             quickCursor = new QuickOutputCursor(q);
-            auto obj = cursorDelegate->createWithInitialProperties({{"cursor", QVariant::fromValue(quickCursor)}}, qmlContext(q));
-            auto item = qobject_cast<QQuickItem*>(obj);
+            Q_ASSERT(window);
 
-            if (!item)
-                qFatal("Must using Item for the Cursor delegate");
+            QQuickItem *item = nullptr;
+            if (cursorDelegate) {
+                auto obj = cursorDelegate->createWithInitialProperties({{"cursor", QVariant::fromValue(quickCursor)}}, qmlContext(q));
+                item = qobject_cast<QQuickItem*>(obj);
 
-            QQmlEngine::setObjectOwnership(item, QQmlEngine::CppOwnership);
+                if (!item)
+                    qFatal("Must using Item for the Cursor delegate");
+
+                QQmlEngine::setObjectOwnership(item, QQmlEngine::CppOwnership);
+                item->setParentItem(window->contentItem());
+            } else {
+                item = new OutputCursorItem(quickCursor, window->contentItem());
+            }
             item->setZ(qreal(WOutputLayout::Layer::Cursor));
-            Q_ASSERT(window);
-            item->setParentItem(window->contentItem());
 
             quickCursor->setDelegateItem(item);
             cursors.append(quickCursor);
@@ -321,6 +642,7 @@ void WOutputViewportPrivate::updateCursors()
         quickCursor->setSize(QSizeF(cursor->width, cursor->height) / cursor->output->scale);
         quickCursor->setSourceRect(QRectF(cursor->src_box.x, cursor->src_box.y, cursor->src_box.width, cursor->src_box.height));
         quickCursor->setTexture(cursor->texture);
+        quickCursor->setXCursor(xcursorManager, xcursorName, cursor->output->scale);
 
         ++index;
     }
@@ -440,6 +762,68 @@ void WOutputViewport::setCursorDelegate(QQmlComponent *delegate)
     Q_EMIT cursorDelegateChanged();
 }
 
+bool WOutputViewport::predictiveFrameCallback() const
+{
+    W_DC(WOutputViewport);
+    return d->predictiveFrameCallback;
+}
+
+void WOutputViewport::setPredictiveFrameCallback(bool newPredictiveFrameCallback)
+{
+    W_D(WOutputViewport);
+    if (d->predictiveFrameCallback == newPredictiveFrameCallback)
+        return;
+    d->predictiveFrameCallback = newPredictiveFrameCallback;
+    Q_EMIT predictiveFrameCallbackChanged();
+}
+
+int WOutputViewport::refreshInterval() const
+{
+    W_DC(WOutputViewport);
+    if (!d->output)
+        return 0;
+
+    // mHz
+    const int refresh = d->output->handle()->handle()->refresh;
+    return refresh > 0 ? 1000000 / refresh : 0;
+}
+
+qint64 WOutputViewport::nextRenderTime() const
+{
+    W_DC(WOutputViewport);
+    return d->nextRenderTime;
+}
+
+bool WOutputViewport::delayRender() const
+{
+    W_DC(WOutputViewport);
+    return d->delayRender;
+}
+
+void WOutputViewport::setDelayRender(bool newDelayRender)
+{
+    W_D(WOutputViewport);
+    if (d->delayRender == newDelayRender)
+        return;
+    d->delayRender = newDelayRender;
+    Q_EMIT delayRenderChanged();
+}
+
+int WOutputViewport::renderSafetyMargin() const
+{
+    W_DC(WOutputViewport);
+    return d->renderSafetyMargin;
+}
+
+void WOutputViewport::setRenderSafetyMargin(int newRenderSafetyMargin)
+{
+    W_D(WOutputViewport);
+    if (d->renderSafetyMargin == newRenderSafetyMargin)
+        return;
+    d->renderSafetyMargin = newRenderSafetyMargin;
+    Q_EMIT renderSafetyMarginChanged();
+}
+
 void WOutputViewport::classBegin()
 {
     W_D(WOutputViewport);
@@ -20,6 +20,9 @@ class WAYLIB_SERVER_EXPORT WOutputViewport : public QQuickItem
     Q_PROPERTY(WQuickSeat* seat READ seat WRITE setSeat NOTIFY seatChanged)
     Q_PROPERTY(qreal devicePixelRatio READ devicePixelRatio WRITE setDevicePixelRatio NOTIFY devicePixelRatioChanged)
     Q_PROPERTY(QQmlComponent* cursorDelegate READ cursorDelegate WRITE setCursorDelegate NOTIFY cursorDelegateChanged)
+    Q_PROPERTY(bool predictiveFrameCallback READ predictiveFrameCallback WRITE setPredictiveFrameCallback NOTIFY predictiveFrameCallbackChanged FINAL)
+    Q_PROPERTY(bool delayRender READ delayRender WRITE setDelayRender NOTIFY delayRenderChanged FINAL)
+    Q_PROPERTY(int renderSafetyMargin READ renderSafetyMargin WRITE setRenderSafetyMargin NOTIFY renderSafetyMarginChanged FINAL)
     QML_NAMED_ELEMENT(OutputViewport)
 
 public:
@@ -37,13 +40,36 @@ public:
     qreal devicePixelRatio() const;
     void setDevicePixelRatio(qreal newDevicePixelRatio);
 
+    // If null, the cursors are drawn by the scene graph nodes on the top, and
+    // a move of them only damages the outputs under the cursor rectangles.
     QQmlComponent *cursorDelegate() const;
     void setCursorDelegate(QQmlComponent *delegate);
 
+    // If true, the frame callbacks of surfaces are not sent on frameDone, but
+    // sent ahead of the next frame by the commit turnaround of each surface.
+    bool predictiveFrameCallback() const;
+    void setPredictiveFrameCallback(bool newPredictiveFrameCallback);
+    // msecs, 0 if unknown
+    int refreshInterval() const;
+    // CLOCK_MONOTONIC nsecs, the predicted start of the render of next frame,
+    // updated before frameDone, 0 if unknown
+    qint64 nextRenderTime() const;
+
+    // If true, the render after the frame event is delayed to just before the
+    // next vblank, by the 95th percentile of the recent render durations and
+    // the renderSafetyMargin (msecs).
+    bool delayRender() const;
+    void setDelayRender(bool newDelayRender);
+    int renderSafetyMargin() const;
+    void setRenderSafetyMargin(int newRenderSafetyMargin);
+
 Q_SIGNALS:
     void seatChanged();
     void devicePixelRatioChanged();
     void cursorDelegateChanged();
+    void predictiveFrameCallbackChanged();
+    void delayRenderChanged();
+    void renderSafetyMarginChanged();
     void frameDone();
 
 private:
@@ -7,6 +7,8 @@
 #include "wquickoutputlayout.h"
 #include "woutputpositioner.h"
 #include "wxcursorimage.h"
+#include "woutput.h"
+#include "wxcursorthemecache_p.h"
 
 #include <qwxcursormanager.h>
 
@@ -39,7 +41,8 @@ class WQuickCursorPrivate : public WCursorPrivate
 public:
     WQuickCursorPrivate(WQuickCursor *qq);
     ~WQuickCursorPrivate() {
-        delete xcursor_manager;
+        if (xcursor_manager)
+            WXCursorThemeCache::instance()->release(xcursor_manager);
     }
 
     inline static WQuickCursorPrivate *get(WQuickCursor *qq) {
@@ -57,6 +60,7 @@ public:
 
     void setCursorImageUrl(const QUrl &url);
     void updateXCursorManager();
+    void updateCursorThemeScales();
 
     inline quint32 getCursorSize() const {
         return qMax(cursorSize.width(), cursorSize.height());
@@ -81,6 +85,7 @@ void WQuickCursorPrivate::updateRenderWindows()
     QList<WOutputRenderWindow*> newList;
 
     W_Q(WQuickCursor);
+    updateCursorThemeScales();
     for (auto o : q->layout()->outputs()) {
         QObject::connect(o, SIGNAL(windowChanged(QQuickWindow*)),
                          q, SLOT(updateRenderWindows()), Qt::UniqueConnection);
@@ -166,10 +171,27 @@ void WQuickCursorPrivate::onCursorPositionChanged()
 
 void WQuickCursorPrivate::updateXCursorManager()
 {
-    if (xcursor_manager) delete xcursor_manager;
-    const char *cursor_theme = xcursorThemeName.isEmpty() ? nullptr : qPrintable(xcursorThemeName);
-    auto xm = QWXCursorManager::create(cursor_theme, getCursorSize());
+    auto cache = WXCursorThemeCache::instance();
+    auto oldManager = xcursor_manager;
+    // Shared with the other cursors which are using the same theme and size
+    auto xm = cache->acquire(xcursorThemeName.toLocal8Bit(), getCursorSize());
     q_func()->setXCursorManager(xm);
+    if (oldManager)
+        cache->release(oldManager);
+
+    updateCursorThemeScales();
+}
+
+void WQuickCursorPrivate::updateCursorThemeScales()
+{
+    if (!xcursor_manager || !outputLayout)
+        return;
+
+    W_Q(WQuickCursor);
+    for (auto o : outputLayout->outputs()) {
+        QObject::connect(o, SIGNAL(scaleChanged()), q, SLOT(updateCursorThemeScales()), Qt::UniqueConnection);
+        WXCursorThemeCache::instance()->preload(xcursor_manager, o->scale());
+    }
 }
 
 WQuickCursor::WQuickCursor(QObject *parent)
@@ -86,6 +86,7 @@ private:
     W_PRIVATE_SLOT(void updateRenderWindows())
     W_PRIVATE_SLOT(void updateCurrentRenderWindow())
     W_PRIVATE_SLOT(void updateXCursorManager())
+    W_PRIVATE_SLOT(void updateCursorThemeScales())
 };
 
 WAYLIB_SERVER_END_NAMESPACE
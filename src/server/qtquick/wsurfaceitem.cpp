@@ -8,6 +8,7 @@
 #include "wcursor.h"
 #include "woutput.h"
 #include "woutputviewport.h"
+#include "wframerategovernor.h"
 
 #include <qwcompositor.h>
 #include <qwsubcompositor.h>
@@ -16,18 +17,24 @@
 
 #include <QQuickWindow>
 #include <QSGSimpleTextureNode>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 #include <private/qquickitem_p.h>
 
 extern "C" {
 #define static
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_subcompositor.h>
+#include <wlr/types/wlr_buffer.h>
+#include <wlr/render/wlr_texture.h>
 #undef static
 }
 
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(qLcSurfaceItemSubsurface, "waylib.server.surfaceitem.subsurface", QtWarningMsg)
+
 class ContentItem;
 class WSGTextureProvider : public QSGTextureProvider
 {
@@ -41,12 +48,19 @@ public:
     void updateTexture(); // in render thread
     void maybeUpdateTextureOnSurfacePrrimaryOutputChanged();
     void reset();
+    void detach();
 
     QWTexture *ensureTexture();
 
 private:
+    void setBuffer(QWBuffer *newBuffer);
+    QWTexture *copyShmBuffer(wlr_client_buffer *clientBuffer) const;
+
     ContentItem *item;
     QWBuffer *buffer = nullptr;
+    // The lock is ignored by the wlr_client_buffer, so the next
+    // commit can upload to the texture of this buffer in place
+    bool lockIgnored = false;
     std::unique_ptr<QWTexture> qwtexture;
     std::unique_ptr<WTexture> dwtexture;
 };
@@ -74,6 +88,8 @@ public:
     void updateFrameDoneConnection();
 
     void onHasSubsurfaceChanged();
+    void onSurfaceCommitted();
+    void onBufferChanged();
     void updateSubsurfaceItem();
     void onPaddingsChanged();
     void updateContentItemPosition();
@@ -81,6 +97,7 @@ public:
 
     void resizeSurfaceToItemSize(const QSize &itemSize, const QSize &sizeDiff);
     void updateEventItem(bool forceDestroy);
+    bool handleEvent(QEvent *event);
     void doResize(WSurfaceItem::ResizeMode mode);
 
     inline QSizeF paddingsSize() const {
@@ -100,10 +117,18 @@ public:
     WSurfaceItem::Flags surfaceFlags;
     QMarginsF paddings;
     QList<WSurfaceItem*> subsurfaces;
+    QHash<WSurface*, WSurfaceItem*> subsurfaceItems;
+    // The children order applied at last, includes the contentItem
+    QList<QQuickItem*> subsurfaceStack;
     qreal surfaceSizeRatio = 1.0;
 
     QMetaObject::Connection frameDoneConnection;
     uint32_t beforeRequestResizeSurfaceStateSeq = 0;
+    // The commits are applied at the next polish
+    bool hasPendingCommit = false;
+    // The new buffer is not applied if the item is frozen
+    bool hasPendingBuffer = false;
+    int frozenCount = 0;
 };
 
 class ContentItem : public QQuickItem
@@ -125,15 +150,21 @@ public:
     bool isTextureProvider() const override;
     QSGTextureProvider *textureProvider() const override;
 
+    // Used as the eventItem of WSurfaceItem if MergeEventItem is enabled
+    void setEventEnabled(bool on);
+    bool contains(const QPointF &point) const override;
+
 private:
     QSGNode *updatePaintNode(QSGNode *, UpdatePaintNodeData *) override;
     void releaseResources() override;
+    bool event(QEvent *event) override;
 
     // Using by Qt library
     Q_SLOT void invalidateSceneGraph();
 
     WSGTextureProvider *m_textureProvider = nullptr;
     QMetaObject::Connection m_updateTextureConnection;
+    bool m_eventEnabled = false;
 };
 
 class EventItem : public QQuickItem
@@ -165,35 +196,8 @@ public:
 
 private:
     bool event(QEvent *event) override {
-        switch(event->type()) {
-        using enum QEvent::Type;
-        // Don't insert events before MouseButtonPress
-        case MouseButtonPress: Q_FALLTHROUGH();
-        case MouseButtonRelease: Q_FALLTHROUGH();
-        case MouseMove: Q_FALLTHROUGH();
-        case HoverMove:
-            if (static_cast<QMouseEvent*>(event)->source() != Qt::MouseEventNotSynthesized)
-                return true; // The non-native events don't send to WSeat
-            Q_FALLTHROUGH();
-        case HoverEnter: Q_FALLTHROUGH();
-        case HoverLeave: Q_FALLTHROUGH();
-        case KeyPress: Q_FALLTHROUGH();
-        case KeyRelease: Q_FALLTHROUGH();
-        case TouchBegin: Q_FALLTHROUGH();
-        case TouchUpdate: Q_FALLTHROUGH();
-        case TouchEnd: Q_FALLTHROUGH();
-        case TouchCancel: {
-            auto e = static_cast<QInputEvent*>(event);
-            if (static_cast<ContentItem*>(parent())->surfaceItem()->sendEvent(e))
-                return true;
-            break;
-        }
-        case FocusOut: {
-            if (isValid())
-                d()->q_func()->setFocus(false);
-            break;
-        }
-        }
+        if (isValid() && d()->handleEvent(event))
+            return true;
 
         return QQuickItem::event(event);
     }
@@ -227,6 +231,37 @@ QSGTextureProvider *ContentItem::textureProvider() const
     return m_textureProvider;
 }
 
+void ContentItem::setEventEnabled(bool on)
+{
+    if (m_eventEnabled == on)
+        return;
+
+    m_eventEnabled = on;
+    setAcceptHoverEvents(on);
+    setAcceptTouchEvents(on);
+    setAcceptedMouseButtons(on ? Qt::AllButtons : Qt::NoButton);
+}
+
+bool ContentItem::contains(const QPointF &point) const
+{
+    if (!m_eventEnabled)
+        return QQuickItem::contains(point);
+
+    auto surfaceItem = this->surfaceItem();
+    if (Q_UNLIKELY(!surfaceItem || !d()->surface))
+        return false;
+
+    return d()->surface->inputRegionContains(point);
+}
+
+bool ContentItem::event(QEvent *event)
+{
+    if (m_eventEnabled && surfaceItem() && d()->handleEvent(event))
+        return true;
+
+    return QQuickItem::event(event);
+}
+
 QSGNode *ContentItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
     if (!m_textureProvider || !m_textureProvider->texture() || width() <= 0 || height() <= 0) {
@@ -296,14 +331,13 @@ WSGTextureProvider::WSGTextureProvider(ContentItem *item)
 
 WSGTextureProvider::~WSGTextureProvider()
 {
-    if (buffer)
-        buffer->unlock();
-    buffer = nullptr;
+    setBuffer(nullptr);
 }
 
 QSGTexture *WSGTextureProvider::texture() const
 {
-    if (!buffer)
+    // The contents of a detached SHM buffer is only in qwtexture
+    if (!buffer && !qwtexture)
         return nullptr;
 
     return dwtexture->getSGTexture(item->window());
@@ -314,12 +348,8 @@ void WSGTextureProvider::updateTexture()
     if (qwtexture)
         qwtexture.reset();
 
-    if (buffer)
-        buffer->unlock();
-    buffer = item->d()->surface->buffer();
     // lock buffer to ensure the WSurfaceItem can keep the last frame after WSurface destroyed.
-    if (buffer)
-        buffer->lock();
+    setBuffer(item->d()->surface->buffer());
 
     dwtexture->setHandle(ensureTexture());
     Q_EMIT textureChanged();
@@ -343,14 +373,86 @@ void WSGTextureProvider::reset()
 {
     if (qwtexture)
         qwtexture.reset();
-    if (buffer)
-        buffer->unlock();
-    buffer = nullptr;
+    setBuffer(nullptr);
     dwtexture->setHandle(nullptr);
     Q_EMIT textureChanged();
     item->update();
 }
 
+// Keep the contents of current buffer after the surface committed the next
+// buffer, called when the item is frozen or the surface is destroyed.
+void WSGTextureProvider::detach()
+{
+    auto clientBuffer = buffer ? QWClientBuffer::get(buffer) : nullptr;
+    if (!clientBuffer)
+        return;
+
+    // The texture of SHM buffer maybe refers to the memory of client (e.g. the
+    // pixman renderer), copy it to a texture of compositor and release the buffer
+    // at once, otherwise the client has to allocate another buffer for next frame.
+    if (auto texture = copyShmBuffer(clientBuffer->handle())) {
+        setBuffer(nullptr);
+        qwtexture.reset(texture);
+        dwtexture->setHandle(texture);
+        Q_EMIT textureChanged();
+        item->update();
+        return;
+    }
+
+    // The texture is owned by the client buffer, don't update it in place
+    if (lockIgnored) {
+        Q_ASSERT(clientBuffer->handle()->n_ignore_locks > 0);
+        clientBuffer->handle()->n_ignore_locks--;
+        lockIgnored = false;
+    }
+}
+
+void WSGTextureProvider::setBuffer(QWBuffer *newBuffer)
+{
+    if (buffer) {
+        if (lockIgnored) {
+            auto clientBuffer = QWClientBuffer::get(buffer);
+            Q_ASSERT(clientBuffer && clientBuffer->handle()->n_ignore_locks > 0);
+            clientBuffer->handle()->n_ignore_locks--;
+        }
+        buffer->unlock();
+    }
+
+    buffer = newBuffer;
+    lockIgnored = false;
+    if (!buffer)
+        return;
+
+    buffer->lock();
+    // Same as WSurfacePrivate::setBuffer
+    if (auto clientBuffer = QWClientBuffer::get(buffer)) {
+        clientBuffer->handle()->n_ignore_locks++;
+        lockIgnored = true;
+    }
+}
+
+QWTexture *WSGTextureProvider::copyShmBuffer(wlr_client_buffer *clientBuffer) const
+{
+    // The source is released after uploaded if the texture doesn't refer to it,
+    // then the memory is owned by the client again, and the texture is a copy.
+    wlr_buffer *source = clientBuffer->source;
+    if (!source || source->n_locks == 0 || !clientBuffer->texture)
+        return nullptr;
+
+    void *data = nullptr;
+    uint32_t format = 0;
+    size_t stride = 0;
+    // Only the SHM buffer can be accessed by the data pointer
+    if (!wlr_buffer_begin_data_ptr_access(source, WLR_BUFFER_DATA_PTR_ACCESS_READ, &data, &format, &stride))
+        return nullptr;
+
+    auto texture = wlr_texture_from_pixels(clientBuffer->texture->renderer, format, stride,
+                                           source->width, source->height, data);
+    wlr_buffer_end_data_ptr_access(source);
+
+    return texture ? QWTexture::from(texture) : nullptr;
+}
+
 QWTexture *WSGTextureProvider::ensureTexture()
 {
     auto textureHandle = item->d()->surface->handle()->getTexture();
@@ -394,6 +496,10 @@ WSurfaceItem *WSurfaceItem::fromFocusObject(QObject *focusObject)
 {
     if (auto item = qobject_cast<EventItem*>(focusObject))
         return item->d()->q_func();
+    if (auto item = qobject_cast<ContentItem*>(focusObject)) {
+        if (item->m_eventEnabled)
+            return item->surfaceItem();
+    }
     return nullptr;
 }
 
@@ -422,6 +528,8 @@ void WSurfaceItem::setSurface(WSurface *surface)
 
     auto oldSurface = d->surface;
     d->beforeRequestResizeSurfaceStateSeq = 0;
+    d->hasPendingCommit = false;
+    d->hasPendingBuffer = false;
     d->surface = surface;
     if (d->componentComplete) {
         if (oldSurface) {
@@ -510,6 +618,12 @@ void WSurfaceItem::setFlags(const Flags &newFlags)
     d->surfaceFlags = newFlags;
     d->updateEventItem(false);
 
+    for (auto item : std::as_const(d->subsurfaces)) {
+        auto flags = item->flags();
+        flags.setFlag(MergeEventItem, newFlags.testFlag(MergeEventItem));
+        item->setFlags(flags);
+    }
+
     Q_EMIT flagsChanged();
 }
 
@@ -548,6 +662,42 @@ void WSurfaceItem::setSurfaceSizeRatio(qreal ssr)
     surfaceSizeRatioChange();
 }
 
+void WSurfaceItem::freeze()
+{
+    Q_D(WSurfaceItem);
+    if (d->frozenCount++ == 0 && d->contentItem->m_textureProvider)
+        d->contentItem->m_textureProvider->detach();
+
+    for (auto item : std::as_const(d->subsurfaces))
+        item->freeze();
+}
+
+void WSurfaceItem::unfreeze()
+{
+    Q_D(WSurfaceItem);
+    Q_ASSERT(d->frozenCount > 0);
+    for (auto item : std::as_const(d->subsurfaces))
+        item->unfreeze();
+
+    if (--d->frozenCount > 0)
+        return;
+
+    if (d->hasPendingBuffer) {
+        d->hasPendingBuffer = false;
+        if (d->surface && d->contentItem->m_textureProvider)
+            d->contentItem->m_textureProvider->updateTexture();
+    }
+
+    if (d->hasPendingCommit)
+        polish();
+}
+
+bool WSurfaceItem::isFrozen() const
+{
+    Q_D(const WSurfaceItem);
+    return d->frozenCount > 0;
+}
+
 qreal WSurfaceItem::bufferScale() const
 {
     Q_D(const WSurfaceItem);
@@ -665,6 +815,10 @@ void WSurfaceItem::itemChange(ItemChange change, const ItemChangeData &data)
         // Use static_cast to avoid convert failed.
         auto item = static_cast<WSurfaceItem*>(data.item);
         if (item && d->subsurfaces.removeOne(item)) {
+            d->subsurfaceItems.removeIf([item] (const auto &it) {
+                return it.value() == item;
+            });
+            d->subsurfaceStack.removeOne(item);
             Q_EMIT subsurfaceRemoved(item);
         }
     }
@@ -684,6 +838,8 @@ void WSurfaceItem::releaseResources()
     Q_D(WSurfaceItem);
 
     d->beforeRequestResizeSurfaceStateSeq = 0;
+    d->hasPendingCommit = false;
+    d->hasPendingBuffer = false;
 
     if (d->contentItem->m_updateTextureConnection)
         QObject::disconnect(d->contentItem->m_updateTextureConnection);
@@ -698,6 +854,9 @@ void WSurfaceItem::releaseResources()
     }
 
     if (!d->surfaceFlags.testFlag(DontCacheLastBuffer)) {
+        if (d->contentItem->m_textureProvider)
+            d->contentItem->m_textureProvider->detach();
+
         for (auto item : d->subsurfaces) {
             item->releaseResources();
             // Don't auto destroy subsurfaes's items, ensure save the
@@ -743,10 +902,8 @@ void WSurfaceItem::onSurfaceCommit()
     // the resizeSurfaceToItemSize wants to resize the wl_surface to current size of WSurfaceitem,
     // If change the WSurfaceItem's size at here, you will see the WSurfaceItem flash.
     if (d->beforeRequestResizeSurfaceStateSeq < d->surface->handle()->handle()->current.seq) {
-        if (d->beforeRequestResizeSurfaceStateSeq != 0) {
-            Q_ASSERT(d->beforeRequestResizeSurfaceStateSeq == d->surface->handle()->handle()->current.seq - 1);
-            d->beforeRequestResizeSurfaceStateSeq = 0;
-        }
+        // The commits are coalesced, the current.seq maybe is not the next one
+        d->beforeRequestResizeSurfaceStateSeq = 0;
 
         if (d->effectiveVisible) {
             if (d->resizeMode == WSurfaceItem::SizeFromSurface)
@@ -760,6 +917,18 @@ void WSurfaceItem::onSurfaceCommit()
     d->updateSubsurfaceItem();
 }
 
+void WSurfaceItem::updatePolish()
+{
+    Q_D(WSurfaceItem);
+
+    if (!d->hasPendingCommit || d->frozenCount > 0)
+        return;
+    d->hasPendingCommit = false;
+
+    if (d->surface && d->surface->handle())
+        onSurfaceCommit();
+}
+
 bool WSurfaceItem::resizeSurface(const QSize &newSize)
 {
     Q_UNUSED(newSize);
@@ -849,14 +1018,17 @@ void WSurfaceItemPrivate::initForSurface()
     for (auto item : subsurfaces)
         item->deleteLater();
     subsurfaces.clear();
+    subsurfaceItems.clear();
+    subsurfaceStack.clear();
 
     if (!surfaceState)
         surfaceState.reset(new SurfaceState());
 
     contentItem->m_textureProvider->updateTexture();
     contentItem->m_updateTextureConnection = QObject::connect(surface, &WSurface::bufferChanged,
-                                                              contentItem->m_textureProvider,
-                                                              &WSGTextureProvider::updateTexture);
+                                                              contentItem->m_textureProvider, [this] {
+        onBufferChanged();
+    });
     QObject::connect(surface->handle(), &QWSurface::beforeDestroy, q,
                      &WSurfaceItem::releaseResources, Qt::DirectConnection);
     QObject::connect(surface, &WSurface::primaryOutputChanged, q, [this] {
@@ -866,11 +1038,15 @@ void WSurfaceItemPrivate::initForSurface()
             contentItem->m_textureProvider->maybeUpdateTextureOnSurfacePrrimaryOutputChanged();
     });
     QObject::connect(surface, SIGNAL(hasSubsurfaceChanged()), q, SLOT(onHasSubsurfaceChanged()));
-    QObject::connect(surface->handle(), &QWSurface::commit, q, &WSurfaceItem::onSurfaceCommit);
+    QObject::connect(surface->handle(), &QWSurface::commit, q, [this] {
+        onSurfaceCommitted();
+    });
 
     onHasSubsurfaceChanged();
     updateFrameDoneConnection();
     updateEventItem(false);
+    hasPendingCommit = false;
+    hasPendingBuffer = false;
     q->onSurfaceCommit();
 }
 
@@ -887,7 +1063,13 @@ void WSurfaceItemPrivate::updateFrameDoneConnection()
         if (!viewport)
             return;
         frameDoneConnection = QObject::connect(viewport, &WOutputViewport::frameDone,
-                                               surface, &WSurface::notifyFrameDone);
+                                               surface, [surface = surface.get(), viewport] {
+            const qint64 renderTime = viewport->predictiveFrameCallback() ? viewport->nextRenderTime() : 0;
+            if (auto governor = WFrameRateGovernor::instance())
+                governor->notifyFrameDone(surface, renderTime);
+            else
+                surface->scheduleFrameDone(renderTime);
+        });
     }
 }
 
@@ -899,6 +1081,30 @@ void WSurfaceItemPrivate::onHasSubsurfaceChanged()
         updateSubsurfaceItem();
 }
 
+void WSurfaceItemPrivate::onSurfaceCommitted()
+{
+    Q_Q(WSurfaceItem);
+
+    // The buffer is updated by WSurface::bufferChanged at once, only the
+    // states of item are applied once before the next frame.
+    if (hasPendingCommit)
+        return;
+    hasPendingCommit = true;
+    if (frozenCount == 0)
+        q->polish();
+}
+
+void WSurfaceItemPrivate::onBufferChanged()
+{
+    if (frozenCount > 0) {
+        // The provider keeps the current contents, see WSGTextureProvider::detach
+        hasPendingBuffer = true;
+        return;
+    }
+
+    contentItem->m_textureProvider->updateTexture();
+}
+
 void WSurfaceItemPrivate::updateSubsurfaceItem()
 {
     Q_Q(WSurfaceItem);
@@ -906,40 +1112,54 @@ void WSurfaceItemPrivate::updateSubsurfaceItem()
     Q_ASSERT(surface);
     Q_ASSERT(contentItem);
 
-    QQuickItem *prev = nullptr;
-    wlr_subsurface *subsurface;
-    wl_list_for_each(subsurface, &surface->current.subsurfaces_below, current.link) {
+    QElapsedTimer timer;
+    if (Q_UNLIKELY(qLcSurfaceItemSubsurface().isDebugEnabled()))
+        timer.start();
+
+    QVarLengthArray<QQuickItem*, 16> stack;
+    stack.reserve(subsurfaceStack.size());
+
+    auto updateItem = [&] (wlr_subsurface *subsurface) {
         WSurface *surface = WSurface::fromHandle(subsurface->surface);
         if (!surface)
-            continue;
+            return;
         WSurfaceItem *item = ensureSubsurfaceItem(surface);
-        item->setSurfaceSizeRatio(surfaceSizeRatio);
         Q_ASSERT(item->parentItem() == q);
-        if (prev) {
-            Q_ASSERT(prev->parentItem() == item->parentItem());
-            item->stackAfter(prev);
-        }
-        prev = item;
+        item->setSurfaceSizeRatio(surfaceSizeRatio);
         const QPointF pos = contentItem->position() + QPointF(subsurface->current.x, subsurface->current.y) / surfaceSizeRatio;
-        item->setPosition(pos);
+        if (item->position() != pos)
+            item->setPosition(pos);
+        stack.append(item);
+    };
+
+    wlr_subsurface *subsurface;
+    wl_list_for_each(subsurface, &surface->current.subsurfaces_below, current.link)
+        updateItem(subsurface);
+    stack.append(contentItem);
+    wl_list_for_each(subsurface, &surface->current.subsurfaces_above, current.link)
+        updateItem(subsurface);
+
+    // The items before the first different one are already in order,
+    // a new item is always at the end of the children, so only need to
+    // restack the items from there.
+    int first = 0;
+    while (first < stack.size() && first < subsurfaceStack.size()
+           && stack.at(first) == subsurfaceStack.at(first)) {
+        ++first;
     }
 
-    if (prev)
-        contentItem->stackAfter(prev);
-    prev = contentItem;
+    if (first < stack.size() || stack.size() != subsurfaceStack.size()) {
+        for (int i = qMax(first, 1); i < stack.size(); ++i) {
+            Q_ASSERT(stack.at(i - 1)->parentItem() == stack.at(i)->parentItem());
+            stack.at(i)->stackAfter(stack.at(i - 1));
+        }
+        subsurfaceStack = QList<QQuickItem*>(stack.cbegin(), stack.cend());
+    }
 
-    wl_list_for_each(subsurface, &surface->current.subsurfaces_above, current.link) {
-        WSurface *surface = WSurface::fromHandle(subsurface->surface);
-        if (!surface)
-            continue;
-        WSurfaceItem *item = ensureSubsurfaceItem(surface);
-        item->setSurfaceSizeRatio(surfaceSizeRatio);
-        Q_ASSERT(item->parentItem() == q);
-        Q_ASSERT(prev->parentItem() == item->parentItem());
-        item->stackAfter(prev);
-        prev = item;
-        const QPointF pos = contentItem->position() + QPointF(subsurface->current.x, subsurface->current.y) / surfaceSizeRatio;
-        item->setPosition(pos);
+    if (Q_UNLIKELY(timer.isValid())) {
+        qCDebug(qLcSurfaceItemSubsurface) << q << "synced" << stack.size() - 1 << "subsurfaces in"
+                                          << timer.nsecsElapsed() << "ns, restacked"
+                                          << qMax(0, int(stack.size()) - qMax(first, 1));
     }
 }
 
@@ -967,17 +1187,18 @@ void WSurfaceItemPrivate::updateContentItemPosition()
 
 WSurfaceItem *WSurfaceItemPrivate::ensureSubsurfaceItem(WSurface *subsurfaceSurface)
 {
-    for (int i = 0; i < subsurfaces.count(); ++i) {
-        auto surfaceItem = subsurfaces.at(i);
-        WSurface *surface = surfaceItem->d_func()->surface.get();
-
-        if (surface && surface == subsurfaceSurface)
+    if (auto surfaceItem = subsurfaceItems.value(subsurfaceSurface)) {
+        // The item of a destroyed surface is deleted later, maybe a new
+        // surface is created at the same address before that.
+        if (surfaceItem->d_func()->surface == subsurfaceSurface)
             return surfaceItem;
     }
 
     Q_Q(WSurfaceItem);
     Q_ASSERT(subsurfaceSurface);
     auto surfaceItem = new WSurfaceItem(q);
+    if (surfaceFlags.testFlag(WSurfaceItem::MergeEventItem))
+        surfaceItem->setFlags(WSurfaceItem::MergeEventItem);
     // Delay destroy WSurfaceItem, because if the cause of destroy is because the parent
     // surface destroy, and the parent WSurfaceItem::cacheLastBuffer maybe enabled,
     // will disable this connection at parent WSurfaceItem::releaseResources to save the
@@ -986,8 +1207,12 @@ WSurfaceItem *WSurfaceItemPrivate::ensureSubsurfaceItem(WSurface *subsurfaceSurf
     QObject::connect(subsurfaceSurface, &QWSurface::destroyed,
                      surfaceItem, &WSurfaceItem::deleteLater, Qt::QueuedConnection);
     surfaceItem->setSurface(subsurfaceSurface);
+    // Keep the same freeze count as the parent, it's unfrozen with the parent
+    for (int i = 0; i < frozenCount; ++i)
+        surfaceItem->freeze();
     // remove list element in WSurfaceItem::itemChange
     subsurfaces.append(surfaceItem);
+    subsurfaceItems.insert(subsurfaceSurface, surfaceItem);
     Q_EMIT q->subsurfaceAdded(surfaceItem);
 
     return surfaceItem;
@@ -1014,23 +1239,69 @@ void WSurfaceItemPrivate::resizeSurfaceToItemSize(const QSize &itemSize, const Q
 void WSurfaceItemPrivate::updateEventItem(bool forceDestroy)
 {
     const bool needsEventItem = !forceDestroy && !surfaceFlags.testFlag(WSurfaceItem::RejectEvent);
-    if (bool(eventItem) == needsEventItem)
+    const bool mergeEventItem = surfaceFlags.testFlag(WSurfaceItem::MergeEventItem);
+    if (bool(eventItem) == needsEventItem
+        && (!eventItem || (eventItem == contentItem) == mergeEventItem)) {
         return;
+    }
 
-    if (eventItem) {
+    if (eventItem == contentItem) {
+        contentItem->setEventEnabled(false);
+        eventItem = nullptr;
+    } else if (eventItem) {
         eventItem->setVisible(false);
         eventItem->setParentItem(nullptr);
         eventItem->setParent(nullptr);
         delete eventItem;
         eventItem = nullptr;
-    } else {
-        eventItem = new EventItem(contentItem);
-        QQuickItemPrivate::get(eventItem)->anchors()->setFill(contentItem);
+    }
+
+    if (needsEventItem) {
+        if (mergeEventItem) {
+            contentItem->setEventEnabled(true);
+            eventItem = contentItem;
+        } else {
+            eventItem = new EventItem(contentItem);
+            QQuickItemPrivate::get(eventItem)->anchors()->setFill(contentItem);
+        }
     }
 
     Q_EMIT q_func()->eventItemChanged();
 }
 
+bool WSurfaceItemPrivate::handleEvent(QEvent *event)
+{
+    Q_Q(WSurfaceItem);
+
+    switch(event->type()) {
+    using enum QEvent::Type;
+    // Don't insert events before MouseButtonPress
+    case MouseButtonPress: Q_FALLTHROUGH();
+    case MouseButtonRelease: Q_FALLTHROUGH();
+    case MouseMove: Q_FALLTHROUGH();
+    case HoverMove:
+        if (static_cast<QMouseEvent*>(event)->source() != Qt::MouseEventNotSynthesized)
+            return true; // The non-native events don't send to WSeat
+        Q_FALLTHROUGH();
+    case HoverEnter: Q_FALLTHROUGH();
+    case HoverLeave: Q_FALLTHROUGH();
+    case KeyPress: Q_FALLTHROUGH();
+    case KeyRelease: Q_FALLTHROUGH();
+    case TouchBegin: Q_FALLTHROUGH();
+    case TouchUpdate: Q_FALLTHROUGH();
+    case TouchEnd: Q_FALLTHROUGH();
+    case TouchCancel:
+        return q->sendEvent(static_cast<QInputEvent*>(event));
+    case FocusOut:
+        q->setFocus(false);
+        break;
+    default:
+        break;
+    }
+
+    return false;
+}
+
 void WSurfaceItemPrivate::doResize(WSurfaceItem::ResizeMode mode)
 {
     Q_ASSERT(mode != WSurfaceItem::ManualResize);
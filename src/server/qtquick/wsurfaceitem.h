@@ -50,7 +50,10 @@ public:
 
     enum Flag {
         DontCacheLastBuffer = 0x1,
-        RejectEvent = 0x2
+        RejectEvent = 0x2,
+        // Handle the events by the contentItem instead of a child item of it,
+        // saves an item per surface, it's also applied to the subsurfaces.
+        MergeEventItem = 0x4
     };
     Q_ENUM(Flag)
     Q_DECLARE_FLAGS(Flags, Flag)
@@ -95,6 +98,13 @@ public:
 
     qreal bufferScale() const;
 
+    // Keep the current contents and states of the surface until unfreeze,
+    // the calls are counted and forwarded to the subsurfaces. Used by
+    // WSurfaceTransaction.
+    void freeze();
+    void unfreeze();
+    bool isFrozen() const;
+
 Q_SIGNALS:
     void surfaceChanged();
     void subsurfaceAdded(WSurfaceItem *item);
@@ -116,7 +126,10 @@ protected:
     void itemChange(ItemChange change, const ItemChangeData &data) override;
     void focusInEvent(QFocusEvent *event) override;
     void releaseResources() override;
+    void updatePolish() override;
 
+    // Called at the polish after the commits of surface, the commits
+    // between two frames are applied once.
     Q_SLOT virtual void onSurfaceCommit();
     virtual void initSurface();
     virtual bool sendEvent(QInputEvent *event);
@@ -0,0 +1,255 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wsurfacetransaction.h"
+#include "wsurfaceitem.h"
+#include "wsurface.h"
+#include "wxdgsurface.h"
+
+#include <qwcompositor.h>
+#include <qwxdgshell.h>
+
+#include <QTimer>
+#include <QPointer>
+#include <QLoggingCategory>
+#include <QQmlInfo>
+
+extern "C" {
+#define static
+#include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_xdg_shell.h>
+#undef static
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcSurfaceTransaction, "waylib.server.surfacetransaction", QtWarningMsg)
+
+struct TransactionEntry
+{
+    QPointer<WSurfaceItem> item;
+    QMetaObject::Connection commitConnection;
+    QMetaObject::Connection configureConnection;
+    // The last configure in flight, only for the xdg surfaces
+    uint32_t serial = 0;
+    bool ready = false;
+};
+
+class WSurfaceTransactionPrivate : public WObjectPrivate
+{
+public:
+    WSurfaceTransactionPrivate(WSurfaceTransaction *qq)
+        : WObjectPrivate(qq)
+    {
+
+    }
+
+    void watch(TransactionEntry *entry);
+    void onCommitted(TransactionEntry *entry);
+    void checkFinished();
+    void apply(bool timedOut, bool notify);
+
+    W_DECLARE_PUBLIC(WSurfaceTransaction)
+
+    int timeout = 200;
+    bool running = false;
+    QList<TransactionEntry*> entries;
+    QTimer *timer = nullptr;
+};
+
+void WSurfaceTransactionPrivate::watch(TransactionEntry *entry)
+{
+    WSurface *surface = entry->item ? entry->item->surface() : nullptr;
+    // Can't know whether the other shells are acked, don't wait them
+    auto xdgSurface = surface ? WXdgSurface::fromSurface(surface) : nullptr;
+    if (!xdgSurface) {
+        entry->ready = true;
+        return;
+    }
+
+    auto handle = xdgSurface->handle()->handle();
+    if (handle->configure_idle) {
+        // Not sent yet
+        entry->serial = handle->scheduled_serial;
+    } else if (!wl_list_empty(&handle->configure_list)) {
+        wlr_xdg_surface_configure *configure = wl_container_of(handle->configure_list.prev, configure, link);
+        entry->serial = configure->serial;
+    } else {
+        entry->ready = !xdgSurface->hasPendingSize();
+    }
+
+    // Maybe a resize is requested after the commit of transaction
+    entry->configureConnection = QObject::connect(xdgSurface->handle(), &QWXdgSurface::configure,
+                                                  q_func(), [this, entry] (wlr_xdg_surface_configure *event) {
+        entry->serial = event->serial;
+        entry->ready = false;
+    });
+    entry->commitConnection = QObject::connect(surface->handle(), &QWSurface::commit,
+                                               q_func(), [this, entry] {
+        onCommitted(entry);
+    });
+}
+
+void WSurfaceTransactionPrivate::onCommitted(TransactionEntry *entry)
+{
+    if (entry->ready || !entry->item || !entry->item->surface())
+        return;
+
+    auto xdgSurface = WXdgSurface::fromSurface(entry->item->surface());
+    if (!xdgSurface)
+        return;
+
+    // The resize is throttled, the acked configure maybe is older than the
+    // last requested size, which is sent after the ack
+    if (xdgSurface->hasPendingSize())
+        return;
+
+    // The serial is wrapping
+    const uint32_t current = xdgSurface->handle()->handle()->current.configure_serial;
+    if (int32_t(current - entry->serial) < 0)
+        return;
+
+    entry->ready = true;
+    checkFinished();
+}
+
+void WSurfaceTransactionPrivate::checkFinished()
+{
+    if (!running)
+        return;
+
+    for (auto entry : std::as_const(entries)) {
+        if (!entry->ready && entry->item && entry->item->surface())
+            return;
+    }
+
+    apply(false, true);
+}
+
+void WSurfaceTransactionPrivate::apply(bool timedOut, bool notify)
+{
+    W_Q(WSurfaceTransaction);
+
+    timer->stop();
+
+    const auto list = std::move(entries);
+    entries.clear();
+
+    for (auto entry : list) {
+        QObject::disconnect(entry->commitConnection);
+        QObject::disconnect(entry->configureConnection);
+
+        if (timedOut && !entry->ready && entry->item)
+            qCDebug(qLcSurfaceTransaction) << "Timeout of waiting" << entry->item->surface();
+        // All items are unfrozen in the same event, so they are polished in the same frame
+        if (entry->item)
+            entry->item->unfreeze();
+        delete entry;
+    }
+
+    const bool wasRunning = running;
+    running = false;
+
+    if (!notify)
+        return;
+
+    if (wasRunning)
+        Q_EMIT q->runningChanged();
+    Q_EMIT q->finished(timedOut);
+}
+
+WSurfaceTransaction::WSurfaceTransaction(QObject *parent)
+    : QObject(parent)
+    , WObject(*new WSurfaceTransactionPrivate(this))
+{
+    W_D(WSurfaceTransaction);
+
+    d->timer = new QTimer(this);
+    d->timer->setSingleShot(true);
+    connect(d->timer, &QTimer::timeout, this, [d] {
+        d->apply(true, true);
+    });
+}
+
+WSurfaceTransaction::~WSurfaceTransaction()
+{
+    W_D(WSurfaceTransaction);
+    // Don't keep the items frozen
+    d->apply(false, false);
+}
+
+int WSurfaceTransaction::timeout() const
+{
+    W_DC(WSurfaceTransaction);
+    return d->timeout;
+}
+
+void WSurfaceTransaction::setTimeout(int newTimeout)
+{
+    W_D(WSurfaceTransaction);
+
+    if (newTimeout <= 0) {
+        qmlWarning(this) << "The timeout must be greater than 0";
+        return;
+    }
+
+    if (d->timeout == newTimeout)
+        return;
+    d->timeout = newTimeout;
+    Q_EMIT timeoutChanged();
+}
+
+bool WSurfaceTransaction::isRunning() const
+{
+    W_DC(WSurfaceTransaction);
+    return d->running;
+}
+
+void WSurfaceTransaction::add(WSurfaceItem *item)
+{
+    W_D(WSurfaceTransaction);
+
+    if (!item)
+        return;
+
+    for (auto entry : std::as_const(d->entries)) {
+        if (entry->item == item)
+            return;
+    }
+
+    auto entry = new TransactionEntry;
+    entry->item = item;
+    item->freeze();
+    d->entries.append(entry);
+
+    if (d->running)
+        d->watch(entry);
+}
+
+void WSurfaceTransaction::commit()
+{
+    W_D(WSurfaceTransaction);
+
+    if (d->running) {
+        qmlWarning(this) << "The transaction is already committed";
+        return;
+    }
+
+    d->running = true;
+    for (auto entry : std::as_const(d->entries))
+        d->watch(entry);
+
+    Q_EMIT runningChanged();
+
+    d->timer->start(d->timeout);
+    d->checkFinished();
+}
+
+void WSurfaceTransaction::finish()
+{
+    W_D(WSurfaceTransaction);
+    d->apply(false, true);
+}
+
+WAYLIB_SERVER_END_NAMESPACE
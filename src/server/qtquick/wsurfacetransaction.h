@@ -0,0 +1,51 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <QObject>
+#include <QQmlEngine>
+
+Q_MOC_INCLUDE(<wsurfaceitem.h>)
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WSurfaceItem;
+class WSurfaceTransactionPrivate;
+// Apply the new states of a set of surfaces in one frame, e.g. resizing
+// the tiled windows. Add the items, request the resizes and commit, the
+// items keep their current contents until all the configures in flight
+// are acked and committed by the clients, or the timeout passes.
+class WAYLIB_SERVER_EXPORT WSurfaceTransaction : public QObject, public WObject
+{
+    Q_OBJECT
+    W_DECLARE_PRIVATE(WSurfaceTransaction)
+    Q_PROPERTY(int timeout READ timeout WRITE setTimeout NOTIFY timeoutChanged FINAL)
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged FINAL)
+    QML_NAMED_ELEMENT(SurfaceTransaction)
+
+public:
+    explicit WSurfaceTransaction(QObject *parent = nullptr);
+    ~WSurfaceTransaction();
+
+    // msecs
+    int timeout() const;
+    void setTimeout(int newTimeout);
+
+    bool isRunning() const;
+
+    // The item is frozen at once until the transaction is finished
+    Q_INVOKABLE void add(WAYLIB_SERVER_NAMESPACE::WSurfaceItem *item);
+    Q_INVOKABLE void commit();
+    // Apply all states now
+    Q_INVOKABLE void finish();
+
+Q_SIGNALS:
+    void timeoutChanged();
+    void runningChanged();
+    void finished(bool timedOut);
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -0,0 +1,134 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+// Measure the latency of opening a popup by DynamicCreatorComponent, that is
+// the time of WQmlCreator::add until the delegate object is added, with or
+// without the object pool.
+//
+// Usage:
+//   testCreatorPool [--count 1000] [--pool-size 4]
+
+#include <wqmldynamiccreator_p.h>
+
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QElapsedTimer>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <algorithm>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+static const char *qml = R"(
+import QtQuick
+import Waylib.Server
+
+Item {
+    property alias creator: creator
+    property alias component: component
+
+    DynamicCreator {
+        id: creator
+    }
+
+    DynamicCreatorComponent {
+        id: component
+
+        creator: creator
+
+        // Likes a menu
+        Rectangle {
+            required property string title
+
+            width: 200
+            height: column.height
+            border.width: 1
+            radius: 4
+
+            Column {
+                id: column
+
+                Text {
+                    text: title
+                    font.bold: true
+                }
+
+                Repeater {
+                    model: 12
+
+                    Text {
+                        required property int index
+
+                        width: 200
+                        text: "Item " + index
+                    }
+                }
+            }
+        }
+    }
+}
+)";
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption countOption("count", "The number of popups to open.", "count", "1000");
+    QCommandLineOption poolSizeOption("pool-size", "The poolSize of DynamicCreatorComponent.", "size", "0");
+    parser.addOptions({countOption, poolSizeOption});
+    parser.process(app);
+
+    const int count = qMax(1, parser.value(countOption).toInt());
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData(qml, QUrl());
+    std::unique_ptr<QObject> root(component.create());
+    if (!root) {
+        qWarning() << component.errors();
+        return -1;
+    }
+
+    auto creator = qobject_cast<WQmlCreator*>(root->property("creator").value<QObject*>());
+    auto creatorComponent = qobject_cast<WQmlCreatorComponent*>(root->property("component").value<QObject*>());
+    Q_ASSERT(creator && creatorComponent);
+    creatorComponent->setPoolSize(parser.value(poolSizeOption).toInt());
+
+    QList<qint64> latencies;
+    latencies.reserve(count);
+    QElapsedTimer timer;
+
+    for (int i = 0; i < count; ++i) {
+        QObject owner;
+        const QJSValue properties = engine.toScriptValue(QVariantMap {
+            {QStringLiteral("title"), QStringLiteral("Popup %1").arg(i)},
+        });
+
+        timer.start();
+        creator->add(&owner, properties);
+        latencies.append(timer.nsecsElapsed());
+
+        // The popup is closed by the owner destroyed
+        creator->removeByOwner(&owner);
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    qint64 total = 0;
+    for (auto latency : std::as_const(latencies))
+        total += latency;
+
+    qInfo() << "popups:" << count << "pool size:" << creatorComponent->poolSize();
+    qInfo() << "average latency (us):" << total / 1000.0 / count;
+    qInfo() << "median latency (us):" << latencies.at(count / 2) / 1000.0;
+    qInfo() << "p99 latency (us):" << latencies.at(qMin(count - 1, count * 99 / 100)) / 1000.0;
+
+    return 0;
+}
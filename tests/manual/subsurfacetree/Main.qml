@@ -0,0 +1,55 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+import QtQuick
+import QtQuick.Window
+import subsurfacetree
+
+// Keep committing a tree of 50 subsurfaces, run the compositor with
+// QT_LOGGING_RULES="waylib.server.surfaceitem.subsurface.debug=true"
+// to see the cost of syncing the subsurface items on each commit.
+Window {
+    id: root
+
+    property int frame: 0
+
+    width: 800
+    height: 600
+    visible: true
+    title: qsTr("Wayland Subsurface Tree Benchmark")
+    color: "black"
+
+    Repeater {
+        id: repeater
+
+        model: 50
+
+        CustomWindow {
+            required property int index
+
+            parent: root
+            title: "Subsurface " + index
+            // Only a few subsurfaces are moving, the others are not changed
+            x: (index % 10) * 80 + (index % 7 === 0 ? root.frame % 40 : 0)
+            y: Math.floor(index / 10) * 110
+            width: 70
+            height: 100
+            color: Qt.hsla(index / 50, 0.8, 0.5, 1)
+        }
+    }
+
+    Timer {
+        interval: 16
+        repeat: true
+        running: true
+        onTriggered: {
+            ++root.frame
+            // Restack a subsurface sometimes
+            if (root.frame % 60 === 0) {
+                let item = repeater.itemAt(root.frame / 60 % repeater.count)
+                if (item)
+                    item.raise()
+            }
+        }
+    }
+}
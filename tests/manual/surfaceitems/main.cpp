@@ -0,0 +1,105 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+// Measure the heap memory and the scene graph sync time of many WSurfaceItem,
+// with or without the WSurfaceItem::MergeEventItem flag.
+//
+// Usage:
+//   testSurfaceItems [--count 500] [--frames 100] [--merge]
+//
+// The items have no surface, so the costs of the buffers are not included,
+// it's only the costs of the items of WSurfaceItem.
+
+#include <wsurfaceitem.h>
+
+#include <QGuiApplication>
+#include <QQuickWindow>
+#include <QElapsedTimer>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include <malloc.h>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+static size_t heapUsed()
+{
+    return mallinfo2().uordblks;
+}
+
+static int countItems(QQuickItem *item)
+{
+    int count = 1;
+    const auto children = item->childItems();
+    for (auto child : children)
+        count += countItems(child);
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption countOption("count", "The number of surface items.", "count", "500");
+    QCommandLineOption framesOption("frames", "The number of frames to sync.", "frames", "100");
+    QCommandLineOption mergeOption("merge", "Enable WSurfaceItem::MergeEventItem.");
+    parser.addOptions({countOption, framesOption, mergeOption});
+    parser.process(app);
+
+    const int count = qMax(1, parser.value(countOption).toInt());
+    const int frames = qMax(1, parser.value(framesOption).toInt());
+    WSurfaceItem::Flags flags = WSurfaceItem::DontCacheLastBuffer;
+    if (parser.isSet(mergeOption))
+        flags |= WSurfaceItem::MergeEventItem;
+
+    QQuickWindow window;
+    window.resize(1920, 1080);
+    auto root = window.contentItem();
+
+    const size_t heapBefore = heapUsed();
+    const int itemsBefore = countItems(root);
+
+    QList<WSurfaceItem*> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        auto item = new WSurfaceItem(root);
+        // The event item is created by the flags
+        item->setFlags(flags);
+        item->setPosition(QPointF(i % 40 * 48, i / 40 * 48));
+        item->setSize(QSizeF(40, 40));
+        items.append(item);
+    }
+
+    const size_t heapAfter = heapUsed();
+    const int itemsAfter = countItems(root);
+
+    QElapsedTimer timer;
+    qint64 syncTime = 0;
+    QObject::connect(&window, &QQuickWindow::beforeSynchronizing, &window, [&timer] {
+        timer.start();
+    }, Qt::DirectConnection);
+    QObject::connect(&window, &QQuickWindow::afterSynchronizing, &window, [&timer, &syncTime] {
+        syncTime += timer.nsecsElapsed();
+    }, Qt::DirectConnection);
+
+    for (int frame = 0; frame < frames; ++frame) {
+        // Dirty all items as the surfaces are moving
+        for (auto item : std::as_const(items))
+            item->setX(item->x() + (frame % 2 ? -1 : 1));
+        window.grabWindow();
+    }
+
+    qInfo() << "surface items:" << count << (parser.isSet(mergeOption) ? "(merged event item)" : "");
+    qInfo() << "quick items per surface:" << qreal(itemsAfter - itemsBefore) / count;
+    qInfo() << "heap bytes per surface:" << qreal(heapAfter - heapBefore) / count;
+    qInfo() << "average sync time (us):" << syncTime / 1000.0 / frames;
+
+    qDeleteAll(items);
+    return 0;
+}
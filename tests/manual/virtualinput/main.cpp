@@ -0,0 +1,351 @@
+// Copyright (C) 2023 JiDe Zhang <zhangjide@deepin.org>.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+// Replay high-rate synthetic input through the compositor and measure the
+// dispatch throughput and latency of WCursor -> WSeat -> client.
+//
+// Usage (the compositor must provide the VirtualInputManager):
+//   WLR_BACKENDS=headless tinywl
+//   WAYLAND_DISPLAY=<socket> testVirtualInput [--rate 1000] [--count 10000] [file]
+//
+// The optional file contains the recorded input, one event per line:
+//   m <dx> <dy>     relative pointer motion
+//   b <button>      pointer button click (linux button code, e.g. 272)
+//   p <button>      pointer button press
+//   r <button>      pointer button release
+//   k <key>         key click (evdev key code, e.g. 30)
+// Without the file a circular pointer motion is generated.
+//
+// To measure an interactive resize, press the button on the edge of a window
+// with the resize moves, and run the compositor with
+// QT_LOGGING_RULES="waylib.server.xdgsurface.debug=true" to see how long the
+// configures wait the client and how many sizes are replaced.
+
+#include <QGuiApplication>
+#include <QRasterWindow>
+#include <QPainter>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QCommandLineParser>
+#include <QtMath>
+#include <QDebug>
+
+#include <wayland-client.h>
+#include <xkbcommon/xkbcommon.h>
+
+#include "wlr-virtual-pointer-unstable-v1-client-protocol.h"
+#include "virtual-keyboard-unstable-v1-client-protocol.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <time.h>
+#include <algorithm>
+#include <cstring>
+
+static uint32_t nowMSec()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+struct InputEvent {
+    enum Type {
+        Motion,
+        Button,
+        Press,
+        Release,
+        Key
+    } type;
+    double dx = 0;
+    double dy = 0;
+    uint32_t code = 0;
+};
+
+class Replayer
+{
+public:
+    ~Replayer() {
+        if (keyboard)
+            zwp_virtual_keyboard_v1_destroy(keyboard);
+        if (pointer)
+            zwlr_virtual_pointer_v1_destroy(pointer);
+        if (registry)
+            wl_registry_destroy(registry);
+        if (wrapper)
+            wl_proxy_wrapper_destroy(wrapper);
+        if (queue)
+            wl_event_queue_destroy(queue);
+    }
+
+    bool init(wl_display *display) {
+        this->display = display;
+        // Use a private queue, the default queue is owned by QtWayland
+        queue = wl_display_create_queue(display);
+        wrapper = static_cast<wl_display*>(wl_proxy_create_wrapper(display));
+        wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(wrapper), queue);
+        registry = wl_display_get_registry(wrapper);
+
+        static const wl_registry_listener listener = {
+            .global = [] (void *data, wl_registry *registry, uint32_t name,
+                          const char *interface, uint32_t) {
+                auto self = static_cast<Replayer*>(data);
+                if (strcmp(interface, wl_seat_interface.name) == 0 && !self->seat) {
+                    self->seat = static_cast<wl_seat*>(wl_registry_bind(registry, name, &wl_seat_interface, 1));
+                } else if (strcmp(interface, zwlr_virtual_pointer_manager_v1_interface.name) == 0) {
+                    self->pointerManager = static_cast<zwlr_virtual_pointer_manager_v1*>(
+                        wl_registry_bind(registry, name, &zwlr_virtual_pointer_manager_v1_interface, 1));
+                } else if (strcmp(interface, zwp_virtual_keyboard_manager_v1_interface.name) == 0) {
+                    self->keyboardManager = static_cast<zwp_virtual_keyboard_manager_v1*>(
+                        wl_registry_bind(registry, name, &zwp_virtual_keyboard_manager_v1_interface, 1));
+                }
+            },
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        wl_registry_add_listener(registry, &listener, this);
+        wl_display_roundtrip_queue(display, queue);
+
+        if (!seat || !pointerManager || !keyboardManager) {
+            qWarning() << "The compositor doesn't support the virtual pointer/keyboard protocols";
+            return false;
+        }
+
+        pointer = zwlr_virtual_pointer_manager_v1_create_virtual_pointer(pointerManager, seat);
+        keyboard = zwp_virtual_keyboard_manager_v1_create_virtual_keyboard(keyboardManager, seat);
+
+        return sendKeymap();
+    }
+
+    void motionAbsolute(uint32_t x, uint32_t y, uint32_t extent) {
+        zwlr_virtual_pointer_v1_motion_absolute(pointer, nowMSec(), x, y, extent, extent);
+        zwlr_virtual_pointer_v1_frame(pointer);
+    }
+
+    void send(const InputEvent &event) {
+        const uint32_t time = nowMSec();
+
+        switch (event.type) {
+        case InputEvent::Motion:
+            zwlr_virtual_pointer_v1_motion(pointer, time, wl_fixed_from_double(event.dx),
+                                           wl_fixed_from_double(event.dy));
+            zwlr_virtual_pointer_v1_frame(pointer);
+            break;
+        case InputEvent::Button:
+            zwlr_virtual_pointer_v1_button(pointer, time, event.code, WL_POINTER_BUTTON_STATE_PRESSED);
+            zwlr_virtual_pointer_v1_frame(pointer);
+            zwlr_virtual_pointer_v1_button(pointer, time, event.code, WL_POINTER_BUTTON_STATE_RELEASED);
+            zwlr_virtual_pointer_v1_frame(pointer);
+            break;
+        case InputEvent::Press:
+            zwlr_virtual_pointer_v1_button(pointer, time, event.code, WL_POINTER_BUTTON_STATE_PRESSED);
+            zwlr_virtual_pointer_v1_frame(pointer);
+            break;
+        case InputEvent::Release:
+            zwlr_virtual_pointer_v1_button(pointer, time, event.code, WL_POINTER_BUTTON_STATE_RELEASED);
+            zwlr_virtual_pointer_v1_frame(pointer);
+            break;
+        case InputEvent::Key:
+            zwp_virtual_keyboard_v1_key(keyboard, time, event.code, WL_KEYBOARD_KEY_STATE_PRESSED);
+            zwp_virtual_keyboard_v1_key(keyboard, time, event.code, WL_KEYBOARD_KEY_STATE_RELEASED);
+            break;
+        }
+    }
+
+    void flush() {
+        wl_display_flush(display);
+    }
+
+private:
+    bool sendKeymap() {
+        xkb_rule_names rules = {};
+        auto context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+        auto keymap = xkb_keymap_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        char *string = keymap ? xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1) : nullptr;
+        xkb_keymap_unref(keymap);
+        xkb_context_unref(context);
+
+        if (!string)
+            return false;
+
+        const size_t size = strlen(string) + 1;
+        int fd = memfd_create("virtual-keyboard-keymap", MFD_CLOEXEC);
+        bool ok = fd >= 0 && write(fd, string, size) == ssize_t(size);
+        free(string);
+
+        if (ok)
+            zwp_virtual_keyboard_v1_keymap(keyboard, WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1, fd, size);
+        if (fd >= 0)
+            close(fd);
+
+        return ok;
+    }
+
+    wl_display *display = nullptr;
+    wl_display *wrapper = nullptr;
+    wl_event_queue *queue = nullptr;
+    wl_registry *registry = nullptr;
+    wl_seat *seat = nullptr;
+    zwlr_virtual_pointer_manager_v1 *pointerManager = nullptr;
+    zwp_virtual_keyboard_manager_v1 *keyboardManager = nullptr;
+    zwlr_virtual_pointer_v1 *pointer = nullptr;
+    zwp_virtual_keyboard_v1 *keyboard = nullptr;
+};
+
+class Window : public QRasterWindow
+{
+public:
+    QList<uint32_t> latencies;
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter pa(this);
+        pa.fillRect(QRect(QPoint(0, 0), size()), Qt::darkCyan);
+    }
+
+    void mouseMoveEvent(QMouseEvent *event) override {
+        record(event);
+    }
+    void mousePressEvent(QMouseEvent *event) override {
+        record(event);
+    }
+    void keyPressEvent(QKeyEvent *event) override {
+        record(event);
+    }
+
+private:
+    void record(QInputEvent *event) {
+        // The time of the event is the same as the time of the virtual device request
+        latencies.append(nowMSec() - uint32_t(event->timestamp()));
+    }
+};
+
+static QList<InputEvent> loadEvents(const QString &fileName)
+{
+    QList<InputEvent> events;
+
+    if (fileName.isEmpty()) {
+        for (int i = 0; i < 360; ++i) {
+            const qreal angle = qDegreesToRadians(qreal(i));
+            events.append({InputEvent::Motion, qCos(angle) * 4, qSin(angle) * 4});
+        }
+
+        return events;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Can't open" << fileName;
+        return events;
+    }
+
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        const auto line = stream.readLine().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        if (line.isEmpty() || line.first().startsWith(QLatin1Char('#')))
+            continue;
+
+        if (line.first() == QLatin1String("m") && line.size() == 3) {
+            events.append({InputEvent::Motion, line.at(1).toDouble(), line.at(2).toDouble()});
+        } else if (line.first() == QLatin1String("b") && line.size() == 2) {
+            events.append({InputEvent::Button, 0, 0, line.at(1).toUInt()});
+        } else if (line.first() == QLatin1String("p") && line.size() == 2) {
+            events.append({InputEvent::Press, 0, 0, line.at(1).toUInt()});
+        } else if (line.first() == QLatin1String("r") && line.size() == 2) {
+            events.append({InputEvent::Release, 0, 0, line.at(1).toUInt()});
+        } else if (line.first() == QLatin1String("k") && line.size() == 2) {
+            events.append({InputEvent::Key, 0, 0, line.at(1).toUInt()});
+        }
+    }
+
+    return events;
+}
+
+int main(int argc, char *argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "wayland");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    QCommandLineOption rateOption("rate", "Events per second.", "rate", "1000");
+    QCommandLineOption countOption("count", "Total of events.", "count", "10000");
+    parser.addOptions({rateOption, countOption});
+    parser.addPositionalArgument("file", "The recorded input events.");
+    parser.addHelpOption();
+    parser.process(app);
+
+    const int rate = qMax(1, parser.value(rateOption).toInt());
+    const int count = qMax(1, parser.value(countOption).toInt());
+    const auto events = loadEvents(parser.positionalArguments().value(0));
+    if (events.isEmpty())
+        return -1;
+
+    auto waylandApp = app.nativeInterface<QNativeInterface::QWaylandApplication>();
+    if (!waylandApp)
+        return -1;
+
+    Replayer replayer;
+    if (!replayer.init(waylandApp->display()))
+        return -1;
+
+    Window window;
+    window.showFullScreen();
+
+    int sent = 0;
+    QElapsedTimer elapsed;
+    QTimer timer;
+    timer.setTimerType(Qt::PreciseTimer);
+    timer.setInterval(1);
+
+    QObject::connect(&timer, &QTimer::timeout, &app, [&] {
+        if (!elapsed.isValid()) {
+            // Move the cursor into the fullscreen window
+            replayer.motionAbsolute(1, 1, 2);
+            elapsed.start();
+        }
+
+        const int expected = qMin<qint64>(count, elapsed.nsecsElapsed() * rate / 1000000000);
+        for (; sent < expected; ++sent)
+            replayer.send(events.at(sent % events.size()));
+        replayer.flush();
+
+        if (sent < count)
+            return;
+
+        timer.stop();
+        const qint64 sendTime = elapsed.elapsed();
+        // Wait the in-flight events
+        QTimer::singleShot(500, &app, [&, sendTime] {
+            auto list = window.latencies;
+            std::sort(list.begin(), list.end());
+
+            qInfo() << "sent:" << sent << "received:" << list.size()
+                    << "in" << sendTime << "ms," << (list.size() * 1000.0 / qMax<qint64>(1, sendTime))
+                    << "events/s";
+            if (!list.isEmpty()) {
+                qint64 sum = 0;
+                for (auto i : std::as_const(list))
+                    sum += i;
+                qInfo() << "latency(ms) min:" << list.first()
+                        << "avg:" << double(sum) / list.size()
+                        << "p50:" << list.at(list.size() / 2)
+                        << "p99:" << list.at(list.size() * 99 / 100)
+                        << "max:" << list.last();
+            }
+
+            app.quit();
+        });
+    });
+
+    // Start when the window is mapped and has focus
+    QObject::connect(&window, &QWindow::activeChanged, &app, [&] {
+        if (window.isActive() && !timer.isActive() && sent == 0)
+            timer.start();
+    });
+
+    return app.exec();
+}